@@ -10,7 +10,7 @@ using namespace std;
 class RoomCombinationSolver {
 private:
     struct RoomRequest {
-        string roomType;
+        Interned roomType;
         int quantity;
     };
     
@@ -23,6 +23,8 @@ private:
     
 public:
     bool findRoomCombination(const vector<pair<string, int>>& reqs, Room* rooms, int roomCount);
+    // Same, over rooms that need not be contiguous (e.g. collected with forEachRoom).
+    bool findRoomCombination(const vector<pair<string, int>>& reqs, const vector<Room*>& rooms);
     vector<Room*> getSolution();
 };
 
@@ -0,0 +1,135 @@
+#ifndef BINARYSNAPSHOT_H
+#define BINARYSNAPSHOT_H
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// On-disk format used for store checkpoints.
+enum class StorageFormat { Json, Binary };
+
+// Versioned columnar snapshot file:
+//
+//   header   "HTLSNAP\0", u32 version, u32 endian marker, u32 table count
+//   table    name, u32 row count, u32 column count, columns...
+//   column   name, u8 type, payload
+//
+// Fixed-width columns (int32, float64, bool) are stored as raw arrays so a
+// load is a bulk read plus memcpy; string columns are a string table
+// (u32 offsets[rows + 1] followed by the bytes). Names are u32 length + bytes.
+// Values are native little-endian; files written on another byte order are rejected.
+class BinarySnapshotWriter {
+public:
+    explicit BinarySnapshotWriter(std::ostream& out);
+
+    void writeHeader(uint32_t tableCount);
+    void beginTable(const std::string& name, uint32_t rows, uint32_t columns);
+
+    template <class F>
+    void int32Column(const std::string& name, F get) {
+        beginColumn(name, TYPE_INT32);
+        for (uint32_t i = 0; i < rows; ++i) put(static_cast<int32_t>(get(i)));
+    }
+
+    template <class F>
+    void float64Column(const std::string& name, F get) {
+        beginColumn(name, TYPE_FLOAT64);
+        for (uint32_t i = 0; i < rows; ++i) put(static_cast<double>(get(i)));
+    }
+
+    template <class F>
+    void boolColumn(const std::string& name, F get) {
+        beginColumn(name, TYPE_BOOL);
+        for (uint32_t i = 0; i < rows; ++i) put(static_cast<uint8_t>(get(i) ? 1 : 0));
+    }
+
+    // get(i) must return something convertible to const std::string&.
+    template <class F>
+    void stringColumn(const std::string& name, F get) {
+        beginColumn(name, TYPE_STRING);
+        uint32_t offset = 0;
+        put(offset);
+        for (uint32_t i = 0; i < rows; ++i) {
+            offset += static_cast<uint32_t>(static_cast<const std::string&>(get(i)).size());
+            put(offset);
+        }
+        for (uint32_t i = 0; i < rows; ++i) {
+            const std::string& s = get(i);
+            out.write(s.data(), static_cast<std::streamsize>(s.size()));
+        }
+    }
+
+    bool good() const;
+
+    static const uint8_t TYPE_INT32 = 1;
+    static const uint8_t TYPE_FLOAT64 = 2;
+    static const uint8_t TYPE_BOOL = 3;
+    static const uint8_t TYPE_STRING = 4;
+
+private:
+    template <class T>
+    void put(T value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    void putName(const std::string& name);
+    void beginColumn(const std::string& name, uint8_t type);
+
+    std::ostream& out;
+    uint32_t rows;
+};
+
+// Reads a whole snapshot file with one bulk read and exposes its columns.
+class BinarySnapshotReader {
+public:
+    struct Column {
+        std::string name;
+        uint8_t type = 0;
+        const char* data = nullptr;    // fixed-width values or string offsets
+        const char* strings = nullptr; // string bytes (TYPE_STRING only)
+    };
+
+    struct Table {
+        std::string name;
+        uint32_t rows = 0;
+        std::vector<Column> columns;
+
+        const Column* column(const std::string& name, uint8_t type) const;
+    };
+
+    static const uint32_t VERSION = 1;
+
+    // Returns false if the file is missing, truncated or of another version.
+    bool open(const std::string& path);
+    const Table* table(const std::string& name) const;
+
+    static int32_t int32At(const Column& c, uint32_t row) { return get<int32_t>(c.data, row); }
+    static double float64At(const Column& c, uint32_t row) { return get<double>(c.data, row); }
+    static bool boolAt(const Column& c, uint32_t row) { return c.data[row] != 0; }
+    static std::string stringAt(const Column& c, uint32_t row) {
+        uint32_t begin = get<uint32_t>(c.data, row);
+        uint32_t end = get<uint32_t>(c.data, row + 1);
+        return std::string(c.strings + begin, end - begin);
+    }
+
+private:
+    template <class T>
+    static T get(const char* base, uint32_t row) {
+        T value;
+        std::memcpy(&value, base + static_cast<size_t>(row) * sizeof(T), sizeof(T));
+        return value;
+    }
+
+    std::vector<char> buffer;
+    std::vector<Table> tables;
+};
+
+// "rooms.json" -> "rooms.bin"
+std::string binarySnapshotPath(const std::string& jsonPath);
+
+// True if the binary snapshot exists and is at least as recent as the JSON file,
+// so switching --storage back and forth never loads a stale checkpoint.
+bool binarySnapshotIsCurrent(const std::string& jsonPath);
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef CIVILDATE_H
+#define CIVILDATE_H
+
+#include <cstdint>
+
+// A calendar date packed into one int32: days since 1970-01-01 in the
+// proleptic Gregorian calendar. Ordering, range checks and stay lengths are
+// plain integer operations on it. Day/month/year fields exist only at the
+// JSON and snapshot boundaries.
+using DayNumber = std::int32_t;
+
+struct CivilDate {
+    int year;
+    int month; // 1-12
+    int day;   // 1-31
+};
+
+// Howard Hinnant's days_from_civil / civil_from_days: exact for every
+// Gregorian date, leap years included, without tables or loops.
+constexpr DayNumber daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const int yearOfEra = year - era * 400;
+    const int dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+constexpr CivilDate civilFromDays(DayNumber days) {
+    const int z = days + 719468;
+    const int era = (z >= 0 ? z : z - 146096) / 146097;
+    const int dayOfEra = z - era * 146097;
+    const int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const int mp = (5 * dayOfYear + 2) / 153;
+    const int day = dayOfYear - (153 * mp + 2) / 5 + 1;
+    const int month = mp < 10 ? mp + 3 : mp - 9;
+    return CivilDate{yearOfEra + era * 400 + (month <= 2), month, day};
+}
+
+constexpr bool isLeapYear(int year) {
+    return year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+}
+
+constexpr int daysInMonth(int year, int month) {
+    return month == 2 ? (isLeapYear(year) ? 29 : 28) : (month == 4 || month == 6 || month == 9 || month == 11) ? 30 : 31;
+}
+
+// daysFromCivil() rolls an out-of-range day or month over into the next
+// one, so input is checked with this before it is packed.
+constexpr bool isValidCivil(int year, int month, int day) {
+    return month >= 1 && month <= 12 && day >= 1 && day <= daysInMonth(year, month);
+}
+
+static_assert(daysFromCivil(1970, 1, 1) == 0, "epoch");
+static_assert(daysFromCivil(2024, 3, 1) - daysFromCivil(2024, 2, 28) == 2, "leap day");
+static_assert(civilFromDays(daysFromCivil(2000, 2, 29)).day == 29, "round trip");
+
+#endif
@@ -2,18 +2,53 @@
 #define CUSTOMERMANAGER_H
 
 #include "Structures.h"
+#include "OperationLog.h"
+#include "SnapshotWriter.h"
+#include "BinarySnapshot.h"
+#include "SlabStore.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
-#include <unordered_map>
+#include <cstdint>
+#include <vector>
 using namespace std;
 
+class ThreadPool;
+
 class CustomerManager {
 private:
-    Customer* head;
-    int count;
+    // Slab slots keep each customer at a fixed address; handleByKey maps ids to slots.
+    SlabStore<Customer> customers;
     const string CUSTOMER_FILE = "customers.json";
+    OperationLog oplog;
+    SnapshotWriter* snapshotWriter;
+    StorageFormat storageFormat;
+    mutable std::shared_mutex storeMutex;
+    // Bumped on every change; list views compare it to decide when to rebuild.
+    std::atomic<uint64_t> version{0};
     
     void saveToFile();
-    unordered_map<string, Customer*> custIndex;
+    void maybeCheckpoint();
+    string checkpointPath() const;
+    bool loadFromBinary(const string& path);
+    Customer* insertCustomer(Customer customer);
+    bool removeCustomer(const string& id);
+    SlabStore<Customer>::Handle handleOf(CustomerKey key) const;
+    void setHandle(CustomerKey key, SlabStore<Customer>::Handle h);
+    void logPut(Customer& customer);
+    void logDelete(const string& id);
+    void applyLogRecord(OperationLog::Op op, const string& payload);
+    // Slot of each customer by CustomerKey::index(); NO_HANDLE for ids with no customer.
+    static constexpr SlabStore<Customer>::Handle NO_HANDLE = UINT32_MAX;
+    vector<SlabStore<Customer>::Handle> handleByKey;
+    // Handles in fullName order for the sort endpoint, rebuilt only when
+    // version has moved since. Readers share it under the store's shared lock.
+    std::shared_ptr<const vector<SlabStore<Customer>::Handle>> nameOrder;
+    uint64_t nameOrderVersion;
+    std::mutex nameOrderMtx;
+    std::shared_ptr<const vector<SlabStore<Customer>::Handle>> sortedByName();
     
 public:
     CustomerManager();
@@ -22,10 +57,38 @@ public:
     bool addCustomer(string id, string name, string idCard, string phone);
     bool deleteCustomer(string id);
     Customer* findCustomer(string id);
+    // Array lookup for ids already held as keys (reservations, invoices).
+    Customer* findCustomer(CustomerKey key);
     int getCustomerCount();
-    Customer* getHead();
-    void loadFromJson(const string& json);
-    void loadFromFile();
+    // Calls fn(Customer&) for every customer, in storage order.
+    template <class F>
+    void forEachCustomer(F fn) { customers.forEach(fn); }
+    // Calls fn(Customer&) in fullName order, descending unless ascending.
+    template <class F>
+    void forEachCustomerByName(bool ascending, F fn) {
+        const auto order = sortedByName();
+        if (ascending) {
+            for (SlabStore<Customer>::Handle h : *order) fn(customers[h]);
+        } else {
+            for (auto it = order->rbegin(); it != order->rend(); ++it) fn(customers[*it]);
+        }
+    }
+    // With a pool, large arrays are split into chunks parsed concurrently.
+    void loadFromJson(const string& json, ThreadPool* pool = nullptr);
+    void loadFromFile(ThreadPool* pool = nullptr);
+    // Copies the customers and writes the checkpoint on the snapshot thread;
+    // false if no writer is set or a previous snapshot is still running.
+    bool checkpointInBackground();
+    void setSnapshotWriter(SnapshotWriter* writer);
+    // Json keeps customers.json as the checkpoint; Binary checkpoints to customers.bin
+    // and keeps JSON for import (first start) and exportToJson().
+    void setStorageFormat(StorageFormat format);
+    bool exportToJson();
+    OperationLog& getOperationLog();
+    // Reader-writer lock for the whole store. The manager does not take it
+    // itself: callers hold it around every access (see StoreLocks.h).
+    std::shared_mutex& getMutex() const;
+    uint64_t getVersion() const;
 };
 
 #endif
\ No newline at end of file
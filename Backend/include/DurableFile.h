@@ -0,0 +1,47 @@
+#ifndef DURABLEFILE_H
+#define DURABLEFILE_H
+
+#include <cstddef>
+#include <string>
+
+// How far a persisted write is pushed before the writer reports success.
+//   None           write() into the OS page cache (fast, lost on power failure)
+//   FsyncPerBatch  one fdatasync per group-commit batch / synchronous append
+//   FsyncPerOp     each record is written and synced on its own
+//   DSync          the log is opened with O_DSYNC, so every write is synchronous
+// Checkpoint files are fsynced before their rename for any level but None.
+enum class Durability { None, FsyncPerBatch, FsyncPerOp, DSync };
+
+const char* durabilityName(Durability level);
+
+// Append-only file handle with explicit sync, used by the operation logs.
+// POSIX file descriptors on Linux/macOS; _open/_commit on Windows (where DSync
+// is emulated by committing after every write).
+class DurableFile {
+public:
+    DurableFile();
+    ~DurableFile();
+
+    DurableFile(const DurableFile&) = delete;
+    DurableFile& operator=(const DurableFile&) = delete;
+
+    bool openAppend(const std::string& path, bool dsync);
+    bool isOpen() const;
+    void close();
+
+    // Writes all of data; false on I/O error.
+    bool write(const char* data, size_t len);
+    // Flushes file data to stable storage.
+    bool sync();
+
+    // fsyncs an existing file by name (checkpoint .tmp before its rename).
+    static bool syncPath(const std::string& path);
+    // fsyncs the directory holding path so a rename/create survives a crash.
+    static bool syncParentDirectory(const std::string& path);
+
+private:
+    int fd;
+    bool dsync;
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef ENTITYKEY_H
+#define ENTITYKEY_H
+
+#include <string>
+#include <string_view>
+#include "SymbolTable.h"
+
+// Dense 32-bit key standing in for an entity's string id.
+//
+// Each kind of entity has its own dictionary: the first time an id is seen
+// (load, insert, or a reservation naming it) it gets the next key, and the
+// string is kept only there. Records store and compare keys, and managers
+// index their slots by key in a plain vector, so a join is an array lookup
+// instead of hashing the id. Keys are never reused: a deleted id keeps its key
+// and gets it back if the id is added again. The dictionary therefore grows
+// with every id created since startup, up to SymbolTable's MAX_SYMBOLS.
+template <class Kind>
+class EntityKey {
+public:
+    EntityKey() : value(SymbolTable::EMPTY) {}
+    EntityKey(std::string_view id) : value(Kind::dictionary().intern(id)) {}
+    EntityKey(const std::string& id) : EntityKey(std::string_view(id)) {}
+    EntityKey(const char* id) : EntityKey(std::string_view(id)) {}
+
+    // Key of an id that is already known; false, adding nothing, otherwise.
+    // Lookups of request input go through here so unknown ids are not interned.
+    static bool find(std::string_view id, EntityKey& key) {
+        return Kind::dictionary().find(id, key.value);
+    }
+
+    const std::string& str() const { return Kind::dictionary().name(value); }
+    // Position in the kind's dictionary, for key-indexed arrays.
+    SymbolTable::Symbol index() const { return value; }
+    bool empty() const { return value == SymbolTable::EMPTY; }
+
+    bool operator==(const EntityKey& other) const { return value == other.value; }
+    bool operator!=(const EntityKey& other) const { return value != other.value; }
+    // Comparing with a string would intern it; convert once with find() instead.
+    bool operator==(const std::string&) const = delete;
+    bool operator!=(const std::string&) const = delete;
+
+private:
+    SymbolTable::Symbol value;
+};
+
+struct RoomIds {
+    static SymbolTable& dictionary();
+};
+
+struct CustomerIds {
+    static SymbolTable& dictionary();
+};
+
+using RoomKey = EntityKey<RoomIds>;
+using CustomerKey = EntityKey<CustomerIds>;
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef GROUPCOMMITFLUSHER_H
+#define GROUPCOMMITFLUSHER_H
+
+#include "OperationLog.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool;
+
+// Background persistence thread for the stores' operation logs.
+// Attached logs buffer their appends in memory; once per window the flusher
+// writes every log's buffer with a single write each, so N concurrent
+// mutations cost one file write per store instead of N. Request handlers call
+// waitDurable() before acknowledging a write.
+//
+// With an I/O pool the logs are written (and fsynced, per their Durability) in
+// parallel, so a batch waits for the slowest store instead of the sum of all.
+class GroupCommitFlusher {
+public:
+    explicit GroupCommitFlusher(int windowMs = 10);
+    ~GroupCommitFlusher();
+
+    // Must be called before start().
+    void attach(OperationLog& log);
+    // Optional; the pool must outlive the flusher. Must be called before start().
+    void setIoPool(ThreadPool* pool);
+    void start();
+    void stop();
+
+    // Blocks until every record appended before this call has been written.
+    // Flushes inline when the background thread is not running.
+    void waitDurable();
+
+    int getWindowMs() const;
+
+private:
+    void notifyDirty();
+    void run();
+    void flushAll();
+
+    std::vector<OperationLog*> logs;
+    ThreadPool* ioPool;
+    std::chrono::milliseconds window;
+
+    std::mutex mtx;
+    std::condition_variable wakeCv;
+    std::condition_variable durableCv;
+    std::uint64_t startedBatches;
+    std::uint64_t completedBatches;
+    bool dirty;
+    bool running;
+    std::thread worker;
+};
+
+#endif
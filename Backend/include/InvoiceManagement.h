@@ -4,21 +4,46 @@
 #include "Structures.h"
 #include "RoomManagement.h"
 #include "ReservationManagement.h"
+#include "OperationLog.h"
+#include "SnapshotWriter.h"
+#include "BinarySnapshot.h"
+#include "Tombstones.h"
+#include <atomic>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 using namespace std;
 
+class ThreadPool;
+
 class InvoiceManager {
 private:
     Invoice* invoices;
     int capacity;
+    // Slots in use, deleted ones included; getInvoiceCount() reports live invoices.
     int count;
+    Tombstones deleted;
     const string INVOICE_FILE = "invoices.json";
+    OperationLog oplog;
+    SnapshotWriter* snapshotWriter;
+    StorageFormat storageFormat;
+    mutable std::shared_mutex storeMutex;
+    // Bumped on every change; list views compare it to decide when to rebuild.
+    std::atomic<uint64_t> version{0};
     
     void resize();
-    int calculateDays(int d1, int m1, int y1, int d2, int m2, int y2);
     void saveToFile();
+    void maybeCheckpoint();
+    string checkpointPath() const;
+    bool loadFromBinary(const string& path);
     void rebuildIndex();
+    void removeAt(int slot);
+    void compactIfDue();
+    vector<const Invoice*> liveInvoices() const;
+    void logPut(Invoice& invoice);
+    void logDelete(const string& invoiceId);
+    void applyLogRecord(OperationLog::Op op, const string& payload);
     bool existsForReservation(const Reservation& r);
 
     unordered_map<string,int> invoiceIndex;
@@ -27,6 +52,9 @@ public:
     InvoiceManager(int cap = 10);
     ~InvoiceManager();
 
+    // Nights billed for a stay: checkout minus check-in, at least one.
+    static int calculateDays(DayNumber checkIn, DayNumber checkOut);
+
     bool addInvoice(const Invoice& invoice);
     bool deleteInvoice(const string& invoiceId);
     
@@ -36,10 +64,33 @@ public:
     void sortByTotal(bool ascending = false);
     Invoice* findInvoiceById(const string& invoiceId);
     double calculateRevenue(int month, int year);
-    void loadFromJson(const string& json);
-    void loadFromFile();
+    // With a pool, large arrays are split into chunks parsed concurrently.
+    void loadFromJson(const string& json, ThreadPool* pool = nullptr);
+    void loadFromFile(ThreadPool* pool = nullptr);
     int getInvoiceCount();
-    Invoice* getInvoices();
+    // Calls fn(Invoice&) for every invoice, in storage order; deleted slots are skipped.
+    template <class F>
+    void forEachInvoice(F fn) {
+        for (int i = 0; i < count; ++i) {
+            if (!deleted.isDead(i)) fn(invoices[i]);
+        }
+    }
+    // Copies the invoices and writes the checkpoint on the snapshot thread;
+    // false if no writer is set or a previous snapshot is still running.
+    bool checkpointInBackground();
+    void setSnapshotWriter(SnapshotWriter* writer);
+    // Json keeps invoices.json as the checkpoint; Binary checkpoints to invoices.bin
+    // and keeps JSON for import (first start) and exportToJson().
+    void setStorageFormat(StorageFormat format);
+    bool exportToJson();
+    OperationLog& getOperationLog();
+    // Reader-writer lock for the whole store. The manager does not take it
+    // itself: callers hold it around every access (see StoreLocks.h).
+    std::shared_mutex& getMutex() const;
+    uint64_t getVersion() const;
+    // Applies a log record in memory without logging it again (transaction
+    // rollback and recovery).
+    void restoreRecord(OperationLog::Op op, const string& payload);
 };
 
 #endif
@@ -0,0 +1,60 @@
+#ifndef JSONREADER_H
+#define JSONREADER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// One "key": value pair of a flat JSON object. Views point into the input text.
+struct JsonField {
+    std::string_view key;
+    std::string_view raw;  // string contents without quotes, or the literal/number text
+    bool isString = false;
+    bool hasEscapes = false;
+};
+
+// Single-pass, zero-copy reader for arrays of flat JSON objects (the layout of
+// customers.json, reservations.json and invoices.json). Unlike
+// JsonHelper::extractValue, which re-scans an object once per key, the reader
+// walks each object once and hands out string_views; numbers are parsed with
+// std::from_chars. Nested objects/arrays are skipped as a single raw value.
+//
+//   JsonReader reader(text);
+//   while (reader.nextObject()) {
+//       JsonField f;
+//       while (reader.nextField(f)) { ... }
+//   }
+class JsonReader {
+public:
+    explicit JsonReader(std::string_view text);
+
+    // Advances to the next object (works for a top-level array or a single object).
+    bool nextObject();
+    // Reads the next field of the current object; false once the object is closed.
+    bool nextField(JsonField& field);
+
+    // True if the input was malformed; readers stop at the first error.
+    bool failed() const;
+    size_t position() const;
+
+    static bool toInt(const JsonField& field, int& out);
+    static bool toDouble(const JsonField& field, double& out);
+    static bool toBool(const JsonField& field, bool& out);
+    static void toString(const JsonField& field, std::string& out);
+
+    // Splits a top-level array into about `parts` pieces at object boundaries.
+    // Each piece holds whole objects and can be read by its own JsonReader.
+    static std::vector<std::string_view> splitArray(std::string_view text, size_t parts);
+
+private:
+    void skipWhitespace();
+    bool scanString(std::string_view& out, bool& hasEscapes);
+    bool skipNested();
+
+    std::string_view text;
+    size_t pos;
+    bool inObject;
+    bool error;
+};
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Streaming JSON writer that appends straight into a caller-owned buffer, so a
+// whole list is serialized without per-field temporaries. Numbers go through
+// std::to_chars; strings are copied in one piece unless they need escaping.
+//
+// Style::Compact is for HTTP responses. Style::File reproduces the layout of the
+// data files (two-space indent, "key": value, prices with three decimals) so
+// checkpoints written through the writer diff cleanly against older ones.
+//
+//   std::string body;
+//   JsonWriter w(body);
+//   w.beginArray();
+//   for (...) record.writeJson(w);
+//   w.endArray();
+class JsonWriter {
+public:
+    enum class Style { Compact, File };
+
+    // baseIndent is the column of the first top-level value (File style only).
+    explicit JsonWriter(std::string& out, Style style = Style::Compact, int baseIndent = 0);
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    void key(std::string_view name);
+    void value(std::string_view s);
+    void value(const char* s);
+    void value(int v);
+    void value(double v);
+    void value(bool v);
+    void null();
+    // Inserts already-serialized JSON as the next value.
+    void raw(std::string_view json);
+    // Inserts already-serialized "key":value members into the current object
+    // (Compact style).
+    void rawFields(std::string_view members);
+
+    template <class T>
+    void field(std::string_view name, const T& v) {
+        key(name);
+        value(v);
+    }
+
+    std::string& buffer();
+
+    // Appends s with JSON escapes, without quotes.
+    static void appendEscaped(std::string& out, std::string_view s);
+
+    // Writes `count` records as a data-file array; writeRecord(i, writer) emits
+    // record i. One buffer is reused and handed to the stream in large pieces.
+    template <class F>
+    static bool writeFileArray(std::ostream& os, size_t count, F writeRecord) {
+        std::string buf;
+        buf.reserve(FILE_CHUNK_BYTES + 4096);
+        JsonWriter w(buf, Style::File);
+        w.beginArray();
+        for (size_t i = 0; i < count; ++i) {
+            writeRecord(i, w);
+            if (buf.size() >= FILE_CHUNK_BYTES) {
+                os.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+                buf.clear();
+            }
+        }
+        w.endArray();
+        buf += '\n';
+        os.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+        return static_cast<bool>(os);
+    }
+
+private:
+    static const size_t FILE_CHUNK_BYTES = 64 * 1024;
+
+    struct Frame {
+        bool isObject;
+        bool first;
+        int childIndent;
+        int closeIndent;
+    };
+
+    void beforeValue();
+    void newline(int indent);
+    void open(bool isObject, char bracket);
+    void close(char bracket);
+
+    std::string& out;
+    Style style;
+    int baseIndent;
+    std::vector<Frame> stack;
+    bool afterKey;
+};
+
+#endif
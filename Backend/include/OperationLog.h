@@ -0,0 +1,145 @@
+#ifndef OPERATIONLOG_H
+#define OPERATIONLOG_H
+
+#include "DurableFile.h"
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Append-only operation log for one store (rooms, customers, ...).
+// The store's JSON file is a checkpoint; every mutation after it is appended
+// here as a framed record, so a write costs O(record) instead of O(store):
+//
+//   P <len>\n<payload>\n   upsert: payload is the full record JSON
+//   D <len>\n<id>\n        delete by id
+//   T <len>\n<seq>\n       the records of StoreTransaction <seq> precede this
+//
+// Both operations are idempotent, so replaying a log on top of a checkpoint
+// that already contains some of its records yields the same state. T markers
+// are not passed to replay()'s callback; getLastTransaction() reports the
+// highest one, and truncate()/rotate() copy it into the fresh log so it
+// survives checkpoints.
+//
+// For background checkpoints the log can be rotated: current records move to
+// "<path>.1" and are dropped once the checkpoint covering them is on disk.
+// Replay reads the rotated segment first, then the live log.
+//
+// In buffered mode (group commit) appends only go to memory; the owner of the
+// log calls flushPending() to write everything accumulated in one write.
+// Buffered records are tracked per record id: a record changed several times
+// between two flushes is written once, with its latest contents.
+//
+// setDurability() chooses whether (and how often) appends are synced to disk;
+// see Durability in DurableFile.h.
+//
+// While a StoreTransaction is open, setStaging() diverts appends into the
+// transaction; they reach the log only if it commits. The committed records
+// are handed back with enqueue(), which only buffers them (followed by the
+// transaction's T marker): they go out with the next flush, and
+// isFlushedThrough() tells the transaction journal when they are on disk.
+class OperationLog {
+public:
+    enum class Op : char { Put = 'P', Delete = 'D', Commit = 'T' };
+
+    // An append held back by setStaging().
+    struct StagedRecord {
+        Op op;
+        std::string id;
+        std::string payload;
+    };
+
+    // Number of records after which managers rewrite their checkpoint.
+    static const int CHECKPOINT_INTERVAL = 1000;
+
+    explicit OperationLog(std::string path);
+    ~OperationLog();
+
+    void setPath(const std::string& path);
+    const std::string& getPath() const;
+
+    bool appendPut(const std::string& id, const std::string& payload);
+    bool appendDelete(const std::string& id);
+
+    // Reopens the log with the new policy on the next append.
+    void setDurability(Durability level);
+    Durability getDurability() const;
+
+    // onAppend is invoked (outside the log's lock) after each buffered append.
+    void setBuffered(bool enabled, std::function<void()> onAppend = nullptr);
+    bool isBuffered() const;
+    // Writes buffered records to the file; returns false on I/O error.
+    bool flushPending();
+
+    // Non-null: appends are collected into sink instead of being written.
+    void setStaging(std::vector<StagedRecord>* sink);
+    bool isStaging() const;
+
+    // Queues records, then a T marker for transaction, for the next write
+    // without writing anything now, in buffered and unbuffered mode alike.
+    // Returns a mark for isFlushedThrough().
+    std::uint64_t enqueue(const std::vector<StagedRecord>& records, std::uint64_t transaction);
+    // True once every record queued up to mark is in the file, or covered by
+    // a checkpoint (truncate(), dropRotated()).
+    bool isFlushedThrough(std::uint64_t mark) const;
+
+    // Applies every complete record in order and returns how many were applied.
+    // A torn trailing record (crash mid-append) is cut off the file.
+    int replay(const std::function<void(Op, const std::string&)>& apply);
+
+    // Drops all records (live and rotated); called once a checkpoint has been written.
+    void truncate();
+
+    // Moves the current records into the rotated segment, appending to it if a
+    // previous one was never dropped. New appends start a fresh live log.
+    bool rotate();
+    void dropRotated();
+
+    int getRecordCount() const;
+    // Highest transaction marker replayed from the files or enqueued since.
+    std::uint64_t getLastTransaction() const;
+
+private:
+    // One dirty record waiting for the next flush; superseded slots are skipped.
+    struct PendingRecord {
+        Op op;
+        std::string payload;
+        bool live;
+    };
+
+    bool append(Op op, const std::string& id, const std::string& payload);
+    void queueLocked(Op op, const std::string& id, const std::string& payload);
+    static void appendFrame(std::string& out, Op op, const std::string& payload);
+    bool openForAppend();
+    bool writeTransactionMarkerLocked();
+    bool rotateFilesLocked();
+    // fsyncs the log's directory after a create, rename or remove (unless
+    // durability is None), as SnapshotWriter does for checkpoints.
+    bool syncDirectoryLocked();
+    bool writePendingLocked();
+    int replayFile(const std::string& path, const std::function<void(Op, const std::string&)>& apply);
+    std::string rotatedPath() const;
+
+    std::string logPath;
+    DurableFile out;
+    Durability durability;
+    int recordCount;
+
+    bool buffered;
+    std::vector<PendingRecord> pending;
+    std::unordered_map<std::string, size_t> pendingIndex;
+    std::function<void()> appendListener;
+    std::vector<StagedRecord>* staging;
+    // Records queued so far / known to be durable. A failed write leaves
+    // lostMark set until a checkpoint covers the dropped records.
+    std::uint64_t queuedMark;
+    std::uint64_t flushedMark;
+    std::uint64_t lostMark;
+    std::uint64_t rotatedMark;
+    std::uint64_t lastTransaction;
+    mutable std::mutex mtx;
+};
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef PARALLELPARSE_H
+#define PARALLELPARSE_H
+
+#include "JsonReader.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <future>
+#include <string_view>
+#include <vector>
+
+// Chunks smaller than this are not worth a task of their own.
+const size_t PARALLEL_PARSE_MIN_CHUNK = 64 * 1024;
+
+// Parses a JSON array of flat objects with parseChunk(string_view, vector<T>&).
+// With a pool the array is split at object boundaries and the chunks are parsed
+// concurrently; without one (or for small inputs) it is a single chunk.
+// The result keeps the file order: parts[0] holds the first records.
+template <class T, class ParseChunk>
+std::vector<std::vector<T>> parseJsonArrayChunks(std::string_view json, ThreadPool* pool, ParseChunk parseChunk) {
+    size_t parts = 1;
+    if (pool != nullptr && pool->size() > 1) {
+        parts = std::min<size_t>(static_cast<size_t>(pool->size()) * 2, json.size() / PARALLEL_PARSE_MIN_CHUNK);
+        parts = std::max<size_t>(parts, 1);
+    }
+
+    std::vector<std::string_view> chunks = JsonReader::splitArray(json, parts);
+    std::vector<std::vector<T>> results(chunks.size());
+    if (chunks.size() == 1) {
+        parseChunk(chunks[0], results[0]);
+        return results;
+    }
+
+    std::vector<std::future<std::vector<T>>> pending;
+    pending.reserve(chunks.size());
+    for (std::string_view chunk : chunks) {
+        pending.push_back(pool->submit([chunk, &parseChunk]() {
+            std::vector<T> out;
+            parseChunk(chunk, out);
+            return out;
+        }));
+    }
+    for (size_t i = 0; i < pending.size(); ++i) {
+        results[i] = pending[i].get();
+    }
+    return results;
+}
+
+#endif
@@ -4,42 +4,113 @@
 #include "Structures.h"
 #include "CustomerManagement.h"
 #include "RoomManagement.h"
+#include "OperationLog.h"
+#include "SnapshotWriter.h"
+#include "BinarySnapshot.h"
+#include "Tombstones.h"
+#include <atomic>
+#include <shared_mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 using namespace std;
 
+class ThreadPool;
+
 class ReservationManager {
 private:
     Reservation* reservations;
     int capacity;
+    // Slots in use, deleted ones included; getReservationCount() reports live reservations.
     int count;
+    Tombstones deleted;
     const string RESERVATION_FILE = "reservations.json";
+    OperationLog oplog;
+    SnapshotWriter* snapshotWriter;
+    StorageFormat storageFormat;
+    bool deferCheckpoints;
+    mutable std::shared_mutex storeMutex;
+    // Bumped on every change; list views compare it to decide when to rebuild.
+    std::atomic<uint64_t> version{0};
     
     void resize();
     void saveToFile();
+    void maybeCheckpoint();
+    string checkpointPath() const;
+    bool loadFromBinary(const string& path);
     void rebuildIndex();
+    void removeAt(int slot);
+    void compactIfDue();
+    vector<const Reservation*> liveReservations() const;
+    void logPut(Reservation& reservation);
+    void logDelete(const string& resId);
+    void applyLogRecord(OperationLog::Op op, const string& payload);
+    void trackActive(int slot);
+    void untrackActive(int slot);
+    void setStatus(int slot, ReservationStatus status);
 
     unordered_map<string,int> reservationIndex;
+    // Slots of each room's pending and checked-in reservations, in storage
+    // order, by RoomKey::index(). Kept current on insert, delete and every
+    // status change (setStatus), so room lookups never scan the reservations.
+    // Every stored reservation's room has an entry, so a status change under
+    // a room shard only touches that room's list.
+    vector<SmallVector<int, 2>> activeByRoom;
     
 public:
     ReservationManager(int cap = 10);
     ~ReservationManager();
     
     bool makeReservation(string resId, string custId, string roomId, 
-                        int inD, int inM, int inY, int outD, int outM, int outY,
-                        CustomerManager& custMgr, RoomManager& roomMgr, string status = "pending");
+                        DayNumber checkIn, DayNumber checkOut,
+                        CustomerManager& custMgr, RoomManager& roomMgr,
+                        ReservationStatus status = ReservationStatus::Pending);
     bool checkIn(string roomId, RoomManager& roomMgr);
     bool cancelReservation(const string& resId);
     bool checkInByReservationId(const string& resId, RoomManager& roomMgr);
     bool cancelReservation(const string& resId, RoomManager& roomMgr);
     bool deleteReservation(const string& resId, RoomManager& roomMgr);
-    bool updateStatus(const string& resId, const string& newStatus);
+    // Fails for a move the transition table does not allow; the same status is a no-op.
+    bool updateStatus(const string& resId, ReservationStatus newStatus);
+    // The room's checked-in reservation, if any.
     Reservation* findReservationByRoom(string roomId);
+    // The room's checked-in reservation, else its first pending one.
+    const Reservation* findActiveReservation(RoomKey room) const;
+    bool hasActiveReservation(RoomKey room) const;
     Reservation* findReservationById(const string& resId);
-    void loadFromJson(const string& json);
-    void loadFromFile();
+    // With a pool, large arrays are split into chunks parsed concurrently.
+    void loadFromJson(const string& json, ThreadPool* pool = nullptr);
+    void loadFromFile(ThreadPool* pool = nullptr);
     int getReservationCount();
-    Reservation* getReservations();
+    // Calls fn(Reservation&) for every reservation, in storage order; deleted slots are skipped.
+    template <class F>
+    void forEachReservation(F fn) {
+        for (int i = 0; i < count; ++i) {
+            if (!deleted.isDead(i)) fn(reservations[i]);
+        }
+    }
+    // Copies the reservations and writes the checkpoint on the snapshot thread;
+    // false if no writer is set or a previous snapshot is still running.
+    bool checkpointInBackground();
+    void setSnapshotWriter(SnapshotWriter* writer);
+    // Json keeps reservations.json as the checkpoint; Binary checkpoints to reservations.bin
+    // and keeps JSON for import (first start) and exportToJson().
+    void setStorageFormat(StorageFormat format);
+    bool exportToJson();
+    OperationLog& getOperationLog();
+    // Reader-writer lock for the whole store. The manager does not take it
+    // itself: callers hold it around every access (see StoreLocks.h).
+    std::shared_mutex& getMutex() const;
+    uint64_t getVersion() const;
+    // Applies a log record in memory without logging it again (transaction
+    // rollback and recovery).
+    void restoreRecord(OperationLog::Op op, const string& payload);
+    // With room shards, writers share the store lock, so a checkpoint (which
+    // reads the whole store) must not run inside a write. Deferred, the owner
+    // calls runDueCheckpoint() under an exclusive lock instead.
+    void setDeferredCheckpoints(bool deferred);
+    bool checkpointDue() const;
+    void runDueCheckpoint();
 };
 
 #endif
\ No newline at end of file
@@ -2,37 +2,108 @@
 #define ROOMMANAGER_H
 
 #include "Structures.h"
+#include "OperationLog.h"
+#include "SnapshotWriter.h"
+#include "BinarySnapshot.h"
+#include "Tombstones.h"
+#include <atomic>
+#include <shared_mutex>
 #include <string>
-#include <unordered_map>
+#include <vector>
 using namespace std;
 
 class RoomManager {
 private:
     Room* rooms;
     int capacity;
+    // Slots in use, deleted ones included; getRoomCount() reports live rooms.
     int count;
-    unordered_map<string, int> roomIndex;
+    Tombstones deleted;
+    // Slot of each room by RoomKey::index(); -1 for ids with no live room.
+    vector<int> slotByKey;
+    string dataFile;
+    OperationLog oplog;
+    SnapshotWriter* snapshotWriter;
+    StorageFormat storageFormat;
+    bool deferCheckpoints;
+    mutable std::shared_mutex storeMutex;
+    // Bumped on every change; list views compare it to decide when to rebuild.
+    std::atomic<uint64_t> version{0};
     void resize();
     void rebuildIndex();
+    int slotOf(RoomKey key) const;
+    void setSlot(RoomKey key, int slot);
+    void removeAt(int slot);
+    void compactIfDue();
+    vector<const Room*> liveRooms() const;
+    void logPut(Room& room);
+    void logDelete(const string& roomId);
+    void maybeCheckpoint();
+    string checkpointPath() const;
+    bool loadFromBinary(const string& path);
+    void applyLogRecord(OperationLog::Op op, const string& payload);
 
 public:
+    // Longest room type accepted.
+    static const size_t MAX_ROOM_TYPE_LENGTH = 32;
+    // Room types share SymbolTable::global() with service names but get a far
+    // smaller budget, so creating rooms cannot use up the headroom that
+    // ServiceManagement::MAX_NAME_SYMBOLS leaves for services.
+    static const size_t MAX_ROOM_TYPE_SYMBOLS = 1024;
+
     RoomManager(int cap = 100);
     ~RoomManager();
     
+    // Non-empty, at most MAX_ROOM_TYPE_LENGTH bytes, and either interned
+    // already or within the MAX_ROOM_TYPE_SYMBOLS budget.
+    static bool isValidRoomType(const string& roomType);
     bool addRoom(string roomId, string roomType, double pricePerDay);
     bool deleteRoom(string roomId);
     Room* findRoom(string roomId);
-    Room* getRooms();
+    // Array lookup for ids already held as keys (reservations, invoices).
+    Room* findRoom(RoomKey key);
     int getRoomCount();
+    // Calls fn(Room&) for every room, in storage order; deleted slots are skipped.
+    template <class F>
+    void forEachRoom(F fn) {
+        for (int i = 0; i < count; ++i) {
+            if (!deleted.isDead(i)) fn(rooms[i]);
+        }
+    }
     bool updateRoomPrice(string roomId, double newPrice);
     bool setAvailability(string roomId, bool available);
     void updateRoomStatus(string roomId, bool available);
     void sortRoomsByPrice(bool ascending = true);
+    // Appends the room's current state to the operation log (used after service changes).
+    void persistRoom(const string& roomId);
     
-    // File operations
+    // File operations: saveToFile writes a full checkpoint and clears the log,
+    // loadFromFile reads the checkpoint and replays the log on top of it.
     void saveToFile(string filename = "rooms.json");
+    // Copies the rooms and writes the checkpoint on the snapshot thread;
+    // false if no writer is set or a previous snapshot is still running.
+    bool checkpointInBackground();
+    void setSnapshotWriter(SnapshotWriter* writer);
+    // Json keeps rooms.json as the checkpoint; Binary checkpoints to rooms.bin
+    // and keeps JSON for import (first start) and exportToJson().
+    void setStorageFormat(StorageFormat format);
+    bool exportToJson();
     void loadFromFile(string filename = "rooms.json");
     void loadFromJson(const string& jsonStr);
+    OperationLog& getOperationLog();
+    // Reader-writer lock for the whole store. The manager does not take it
+    // itself: callers hold it around every access (see StoreLocks.h).
+    std::shared_mutex& getMutex() const;
+    uint64_t getVersion() const;
+    // Applies a log record in memory without logging it again (transaction
+    // rollback and recovery).
+    void restoreRecord(OperationLog::Op op, const string& payload);
+    // With room shards, writers share the store lock, so a checkpoint (which
+    // reads the whole store) must not run inside a write. Deferred, the owner
+    // calls runDueCheckpoint() under an exclusive lock instead.
+    void setDeferredCheckpoints(bool deferred);
+    bool checkpointDue() const;
+    void runDueCheckpoint();
 };
 
 #endif
@@ -1,12 +1,24 @@
 #ifndef SERVICEMANAGEMENT_H
 #define SERVICEMANAGEMENT_H
 
+#include <cstddef>
 #include <string>
 
 class RoomManager;
+struct Room;
 
 class ServiceManagement {
 public:
+    // Longest service name accepted.
+    static const std::size_t MAX_SERVICE_NAME_LENGTH = 64;
+    // Service names are interned in SymbolTable::global(), which never shrinks.
+    // Once it holds this many symbols, only names already in it are accepted.
+    static const std::size_t MAX_NAME_SYMBOLS = 65536;
+
+    // Non-empty, at most MAX_SERVICE_NAME_LENGTH bytes, and either interned
+    // already or within the MAX_NAME_SYMBOLS budget.
+    static bool isValidServiceName(const std::string& serviceName);
+
     static bool addServiceToRoom(RoomManager& roomMgr,
                                 const std::string& roomId,
                                 const std::string& serviceName,
@@ -22,12 +34,13 @@ public:
 
     static double calculateServiceCharge(RoomManager& roomMgr,
                                         const std::string& roomId);
+    static double calculateServiceCharge(const Room& room);
 
     static void clearServices(RoomManager& roomMgr,
                              const std::string& roomId,
                              bool persist = true);
 
-    // Merge duplicate services within each room (sums quantities, removes duplicate nodes).
+    // Merge duplicate services within each room (sums quantities, removes duplicate entries).
     // Returns number of duplicates removed.
     static int mergeDuplicateServices(RoomManager& roomMgr,
                                      bool persist = true);
@@ -0,0 +1,59 @@
+#ifndef SIZECLASSPOOL_H
+#define SIZECLASSPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Arena allocator with one free list per size class.
+//
+// Blocks are carved out of large chunks; a freed block goes on the free list
+// of its class and is handed out again before the arena grows, so steady
+// churn (services added and removed, rooms reloaded) stops reaching malloc.
+// Requests above the largest class go straight to operator new. Chunks are
+// returned only when the pool is destroyed. Thread-safe.
+class SizeClassPool {
+public:
+    struct Stats {
+        std::uint64_t allocations = 0;      // allocate() calls
+        std::uint64_t frees = 0;            // deallocate() calls
+        std::uint64_t reused = 0;           // allocations served from a free list
+        std::uint64_t chunks = 0;           // arena chunks taken from operator new
+        std::uint64_t largeAllocations = 0; // requests above the largest class
+    };
+
+    static const std::size_t CHUNK_SIZE = 64 * 1024;
+    static const std::size_t MAX_CLASS_SIZE = 4096;
+
+    SizeClassPool();
+    ~SizeClassPool();
+
+    SizeClassPool(const SizeClassPool&) = delete;
+    SizeClassPool& operator=(const SizeClassPool&) = delete;
+
+    void* allocate(std::size_t bytes);
+    // bytes must be the size passed to allocate().
+    void deallocate(void* p, std::size_t bytes);
+
+    Stats getStats() const;
+
+private:
+    // Classes are powers of two from 16 bytes to MAX_CLASS_SIZE.
+    static const std::size_t CLASS_COUNT = 9;
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    static std::size_t classOf(std::size_t bytes);
+
+    mutable std::mutex mtx;
+    FreeBlock* freeLists[CLASS_COUNT];
+    std::vector<char*> chunks;
+    char* bump;
+    std::size_t bumpLeft;
+    Stats stats;
+};
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef SLABSTORE_H
+#define SLABSTORE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Records kept in fixed-size slabs of contiguous slots.
+//
+// A record never moves once inserted: its handle (slot number) and address
+// stay valid until it is erased, so indexes can point at it directly. Erased
+// slots go on a free list and are reused by the next insert, which makes
+// insert and erase O(1). Scans walk the slabs in slot order and skip free
+// slots, touching memory sequentially instead of chasing list pointers.
+template <class T, std::size_t SlabSize = 4096>
+class SlabStore {
+public:
+    using Handle = std::uint32_t;
+
+    SlabStore() : live(0) {}
+
+    SlabStore(const SlabStore&) = delete;
+    SlabStore& operator=(const SlabStore&) = delete;
+
+    Handle insert(T value) {
+        Handle h;
+        if (!freeSlots.empty()) {
+            h = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            h = static_cast<Handle>(used.size());
+            if (h / SlabSize >= slabs.size()) slabs.emplace_back(new T[SlabSize]);
+            used.push_back(0);
+        }
+        (*this)[h] = std::move(value);
+        used[h] = 1;
+        ++live;
+        return h;
+    }
+
+    // Releases the record's contents and puts its slot on the free list.
+    void erase(Handle h) {
+        if (!contains(h)) return;
+        (*this)[h] = T();
+        used[h] = 0;
+        freeSlots.push_back(h);
+        --live;
+    }
+
+    T& operator[](Handle h) { return slabs[h / SlabSize][h % SlabSize]; }
+    const T& operator[](Handle h) const { return slabs[h / SlabSize][h % SlabSize]; }
+
+    bool contains(Handle h) const { return h < used.size() && used[h]; }
+    std::size_t size() const { return live; }
+    bool empty() const { return live == 0; }
+
+    // Allocates slabs up front for n more records.
+    void reserve(std::size_t n) {
+        const std::size_t slots = used.size() + (n > freeSlots.size() ? n - freeSlots.size() : 0);
+        used.reserve(slots);
+        while (slabs.size() * SlabSize < slots) slabs.emplace_back(new T[SlabSize]);
+    }
+
+    // Calls fn(T&) for every record, in slot order.
+    template <class F>
+    void forEach(F fn) {
+        const std::size_t slots = used.size();
+        for (std::size_t s = 0; s < slabs.size() && s * SlabSize < slots; ++s) {
+            T* slab = slabs[s].get();
+            const std::size_t end = std::min(SlabSize, slots - s * SlabSize);
+            for (std::size_t i = 0; i < end; ++i) {
+                if (used[s * SlabSize + i]) fn(slab[i]);
+            }
+        }
+    }
+
+    template <class F>
+    void forEach(F fn) const {
+        const_cast<SlabStore*>(this)->forEach([&fn](const T& value) { fn(value); });
+    }
+
+private:
+    std::vector<std::unique_ptr<T[]>> slabs;
+    // One byte per slot: 1 = holds a record.
+    std::vector<std::uint8_t> used;
+    std::vector<Handle> freeSlots;
+    std::size_t live;
+};
+
+#endif
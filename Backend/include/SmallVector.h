@@ -0,0 +1,158 @@
+#ifndef SMALLVECTOR_H
+#define SMALLVECTOR_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Where SmallVector puts elements that no longer fit inline.
+struct SmallVectorHeap {
+    static void* allocate(std::size_t bytes) { return ::operator new(bytes); }
+    static void deallocate(void* p, std::size_t) { ::operator delete(p); }
+};
+
+// Vector that keeps up to N elements inside the object itself and moves to
+// the heap only past that. A room's services (usually a handful) then live in
+// the room record: walking them is a scan over contiguous memory, and freeing
+// them is N destructor calls with no allocator traffic.
+//
+// Alloc supplies the spill buffers: static allocate(bytes) and
+// deallocate(p, bytes), like SmallVectorHeap.
+template <class T, std::size_t N, class Alloc = SmallVectorHeap>
+class SmallVector {
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SmallVector() : ptr(inlineData()), count(0), cap(N) {}
+
+    SmallVector(const SmallVector& other) : SmallVector() {
+        reserve(other.count);
+        std::uninitialized_copy(other.begin(), other.end(), ptr);
+        count = other.count;
+    }
+
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible<T>::value) : SmallVector() {
+        takeFrom(other);
+    }
+
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) {
+            clear();
+            reserve(other.count);
+            std::uninitialized_copy(other.begin(), other.end(), ptr);
+            count = other.count;
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+        if (this != &other) {
+            clear();
+            releaseHeap();
+            takeFrom(other);
+        }
+        return *this;
+    }
+
+    ~SmallVector() {
+        clear();
+        releaseHeap();
+    }
+
+    iterator begin() { return ptr; }
+    iterator end() { return ptr + count; }
+    const_iterator begin() const { return ptr; }
+    const_iterator end() const { return ptr + count; }
+
+    T& operator[](std::size_t i) { return ptr[i]; }
+    const T& operator[](std::size_t i) const { return ptr[i]; }
+
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    std::size_t capacity() const { return cap; }
+    // True while the elements fit in the inline buffer.
+    bool isInline() const { return ptr == inlineData(); }
+
+    void reserve(std::size_t n) {
+        if (n <= cap) return;
+        T* grown = static_cast<T*>(Alloc::allocate(n * sizeof(T)));
+        for (std::size_t i = 0; i < count; ++i) {
+            ::new (grown + i) T(std::move(ptr[i]));
+            ptr[i].~T();
+        }
+        releaseHeap();
+        ptr = grown;
+        cap = n;
+    }
+
+    template <class... Args>
+    T& emplace_back(Args&&... args) {
+        if (count == cap) reserve(cap * 2);
+        T* slot = ::new (ptr + count) T(std::forward<Args>(args)...);
+        ++count;
+        return *slot;
+    }
+
+    void push_back(T value) { emplace_back(std::move(value)); }
+
+    // Inserts before position i (i <= size()), shifting later elements up.
+    void insert(std::size_t i, T value) {
+        if (i >= count) {
+            emplace_back(std::move(value));
+            return;
+        }
+        // Grow first: the element moved to the end must not live in the old buffer.
+        if (count == cap) reserve(cap * 2);
+        emplace_back(std::move(ptr[count - 1]));
+        for (std::size_t k = count - 2; k > i; --k) ptr[k] = std::move(ptr[k - 1]);
+        ptr[i] = std::move(value);
+    }
+
+    // Removes element i (i < size()), shifting later elements down.
+    void erase(std::size_t i) {
+        for (std::size_t k = i + 1; k < count; ++k) ptr[k - 1] = std::move(ptr[k]);
+        ptr[--count].~T();
+    }
+
+    void clear() {
+        for (std::size_t i = 0; i < count; ++i) ptr[i].~T();
+        count = 0;
+    }
+
+private:
+    T* inlineData() { return reinterpret_cast<T*>(&storage); }
+    const T* inlineData() const { return reinterpret_cast<const T*>(&storage); }
+
+    void releaseHeap() {
+        if (!isInline()) Alloc::deallocate(ptr, cap * sizeof(T));
+        ptr = inlineData();
+        cap = N;
+    }
+
+    // Steals other's heap buffer, or moves its inline elements one by one.
+    void takeFrom(SmallVector& other) {
+        if (other.isInline()) {
+            for (std::size_t i = 0; i < other.count; ++i) ::new (ptr + i) T(std::move(other.ptr[i]));
+            count = other.count;
+            other.clear();
+            return;
+        }
+        ptr = other.ptr;
+        count = other.count;
+        cap = other.cap;
+        other.ptr = other.inlineData();
+        other.count = 0;
+        other.cap = N;
+    }
+
+    T* ptr;
+    std::size_t count;
+    std::size_t cap;
+    typename std::aligned_storage<sizeof(T) * N, alignof(T)>::type storage;
+};
+
+#endif
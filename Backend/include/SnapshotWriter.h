@@ -0,0 +1,61 @@
+#ifndef SNAPSHOTWRITER_H
+#define SNAPSHOTWRITER_H
+
+#include "OperationLog.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <string>
+#include <thread>
+
+// Writes store checkpoints off the request path (BGSAVE-style).
+// A manager copies its records (an in-process point-in-time image), rotates
+// its operation log and hands the copy to scheduleCheckpoint(); the writer
+// thread serializes it to "<path>.tmp" and renames it over <path>. Only after
+// the rename is the rotated log segment dropped, so a crash at any point
+// still replays to the same state.
+class SnapshotWriter {
+public:
+    using WriteFn = std::function<bool(std::ostream&)>;
+
+    SnapshotWriter();
+    ~SnapshotWriter();
+
+    void start();
+    void stop();
+
+    // Returns false (and does nothing) if a checkpoint of this log is still in flight.
+    bool scheduleCheckpoint(OperationLog& log, const std::string& path, WriteFn write);
+
+    // Blocks until no checkpoint of this log is queued or being written.
+    void waitFor(const OperationLog& log);
+
+    // Writes to "<path>.tmp" and renames it over path; false on any I/O error.
+    // Unless durability is None, the file is fsynced before the rename and the
+    // directory after it. Background jobs use their log's durability.
+    static bool writeAtomically(const std::string& path, const WriteFn& write,
+                                Durability durability = Durability::None);
+
+private:
+    struct Job {
+        OperationLog* log;
+        std::string path;
+        WriteFn write;
+    };
+
+    void run();
+    void execute(Job& job);
+
+    std::deque<Job> jobs;
+    std::set<const OperationLog*> inFlight;
+    std::mutex mtx;
+    std::condition_variable jobCv;
+    std::condition_variable idleCv;
+    bool running;
+    std::thread worker;
+};
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef STORELOCKS_H
+#define STORELOCKS_H
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+// Reader-writer locking across the four stores. GETs take shared locks so they
+// run in parallel; mutations take exclusive locks on the stores they change.
+// A request that touches several stores acquires them in one fixed order
+// (rooms, customers, reservations, invoices), so two requests never deadlock.
+//
+// Sharded mode (setRoomShards) partitions the room and reservation stores by
+// roomId hash. A write that only touches one room and its reservations
+// (writeRoom) holds those stores shared plus its shard exclusively, so writes
+// to rooms in different shards run in parallel. Whole-store writes still take
+// the store locks exclusively. Any guard that reads rooms or reservations
+// under a shared store lock also takes every shard shared, which keeps
+// cross-shard iteration consistent. Shards are always taken after the store
+// locks and in index order.
+class StoreLocks {
+public:
+    enum Store : unsigned {
+        Rooms = 1,
+        Customers = 2,
+        Reservations = 4,
+        Invoices = 8,
+        All = Rooms | Customers | Reservations | Invoices
+    };
+    static constexpr unsigned COUNT = 4;
+    static constexpr unsigned SHARDED = Rooms | Reservations;
+
+    // Holds the locks taken by read()/write()/lock()/writeRoom() until destroyed.
+    class Guard {
+    public:
+        Guard(const StoreLocks& locks, unsigned readMask, unsigned writeMask, int exclusiveShard = -1) {
+            for (unsigned i = 0; i < COUNT; ++i) {
+                const unsigned bit = 1u << i;
+                if (writeMask & bit) exclusive[i] = std::unique_lock<std::shared_mutex>(*locks.mutexes[i]);
+                else if (readMask & bit) shared[i] = std::shared_lock<std::shared_mutex>(*locks.mutexes[i]);
+            }
+            if (locks.shards.empty()) return;
+            if (exclusiveShard >= 0) {
+                shard = std::unique_lock<std::shared_mutex>(*locks.shards[static_cast<size_t>(exclusiveShard)]);
+            } else if (readMask & ~writeMask & SHARDED) {
+                sharedShards.reserve(locks.shards.size());
+                for (const auto& m : locks.shards) sharedShards.emplace_back(*m);
+            }
+        }
+
+        Guard(Guard&&) = default;
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+
+    private:
+        std::shared_lock<std::shared_mutex> shared[COUNT];
+        std::unique_lock<std::shared_mutex> exclusive[COUNT];
+        std::vector<std::shared_lock<std::shared_mutex>> sharedShards;
+        std::unique_lock<std::shared_mutex> shard;
+    };
+
+    StoreLocks(std::shared_mutex& rooms, std::shared_mutex& customers,
+               std::shared_mutex& reservations, std::shared_mutex& invoices)
+        : mutexes{&rooms, &customers, &reservations, &invoices} {}
+
+    // 0 or 1 turns sharding off. Call before any guard is taken.
+    void setRoomShards(unsigned count) {
+        shards.clear();
+        if (count < 2) return;
+        for (unsigned i = 0; i < count; ++i) shards.push_back(std::make_unique<std::shared_mutex>());
+    }
+    unsigned getRoomShards() const { return static_cast<unsigned>(shards.size()); }
+    bool isSharded() const { return !shards.empty(); }
+    unsigned shardOf(const std::string& roomId) const {
+        return shards.empty() ? 0 : static_cast<unsigned>(std::hash<std::string>()(roomId) % shards.size());
+    }
+
+    // Shared locks on every store in the mask.
+    Guard read(unsigned mask) const { return Guard(*this, mask, 0); }
+    // Exclusive locks on every store in the mask.
+    Guard write(unsigned mask) const { return Guard(*this, 0, mask); }
+    // Exclusive on writeMask, shared on the rest of readMask.
+    Guard lock(unsigned readMask, unsigned writeMask) const { return Guard(*this, readMask, writeMask); }
+    // A write confined to one room and its reservations: the stores in mask
+    // shared and the room's shard exclusive. Without shards, mask exclusive.
+    Guard writeRoom(unsigned mask, const std::string& roomId) const {
+        if (shards.empty()) return write(mask);
+        return Guard(*this, mask, 0, static_cast<int>(shardOf(roomId)));
+    }
+
+private:
+    std::shared_mutex* mutexes[COUNT];
+    std::vector<std::unique_ptr<std::shared_mutex>> shards;
+};
+
+#endif
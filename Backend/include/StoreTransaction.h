@@ -0,0 +1,110 @@
+#ifndef STORETRANSACTION_H
+#define STORETRANSACTION_H
+
+#include "OperationLog.h"
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class RoomManager;
+class ReservationManager;
+class InvoiceManager;
+
+// transactions.log, plus how far each store's log has to be flushed before
+// the journal's entries are no longer the only durable copy.
+class TransactionJournal {
+public:
+    explicit TransactionJournal(std::string path);
+
+    OperationLog& getOperationLog();
+
+    // Clears the journal once the store logs hold every committed
+    // transaction. Call after the logs were flushed; cheap when nothing is owed.
+    void retire();
+
+private:
+    friend class StoreTransaction;
+    static const int STORE_COUNT = 3;
+
+    OperationLog log;
+    std::mutex mtx;
+    // Per store: the log and the enqueue() mark it must be flushed through.
+    OperationLog* owedLogs[STORE_COUNT];
+    std::uint64_t owedMarks[STORE_COUNT];
+    bool owing;
+    // Sequence number of the last committed transaction; see recover().
+    std::uint64_t lastSequence;
+};
+
+// Unit of work spanning the room, reservation and invoice stores.
+//
+// While a transaction is open, the managers' log appends are staged instead
+// of written. Before changing a record, call touch*() so rollback can put the
+// old version back. commit() writes every staged record as one combined entry
+// in the transaction journal, synced per the journal's Durability; that is the
+// only write it makes. The records are then queued on the stores' own logs
+// (OperationLog::enqueue) and written by their normal group-commit or
+// writer-queue flush, after which TransactionJournal::retire() clears the
+// journal. rollback(), or destroying an uncommitted transaction, restores the
+// touched records in memory and drops the staged records.
+//
+// Each journal entry carries a sequence number that the store logs record as
+// a marker after the transaction's records. If the process dies before the
+// store logs are flushed, recover() re-applies an entry at startup to the
+// stores whose logs lack its marker, so either every change of a transaction
+// survives or none does, and records written after it are never rolled back.
+//
+// The caller holds exclusive locks on the three stores for the transaction's
+// lifetime.
+class StoreTransaction {
+public:
+    StoreTransaction(RoomManager& rooms, ReservationManager& reservations, InvoiceManager& invoices,
+                     TransactionJournal& journal);
+    ~StoreTransaction();
+
+    StoreTransaction(const StoreTransaction&) = delete;
+    StoreTransaction& operator=(const StoreTransaction&) = delete;
+
+    void touchRoom(const std::string& roomId);
+    void touchReservation(const std::string& reservationId);
+    void touchInvoice(const std::string& invoiceId);
+
+    // False if the journal could not be written; the transaction is rolled back.
+    bool commit();
+    void rollback();
+
+    // Re-applies a journal left behind by a crash, then clears it. Run once the
+    // stores are loaded and before the first commit: it also resumes the
+    // journal's sequence numbers. Returns the number of transactions replayed.
+    static int recover(RoomManager& rooms, ReservationManager& reservations, InvoiceManager& invoices,
+                       TransactionJournal& journal);
+
+private:
+    enum Store { Rooms, Reservations, Invoices, STORE_COUNT };
+
+    // A record as it was before the transaction changed it.
+    struct BeforeImage {
+        Store store;
+        std::string id;
+        bool existed;
+        std::string json;
+    };
+
+    void touch(Store store, const std::string& id, const std::string* json);
+    void endStaging();
+    void undo();
+    OperationLog& logFor(Store store) const;
+    void restore(Store store, OperationLog::Op op, const std::string& payload) const;
+
+    RoomManager& rooms;
+    ReservationManager& reservations;
+    InvoiceManager& invoices;
+    TransactionJournal& journal;
+
+    std::vector<OperationLog::StagedRecord> staged[STORE_COUNT];
+    std::vector<BeforeImage> before;
+    bool open;
+};
+
+#endif
@@ -1,68 +1,181 @@
 #ifndef STRUCTURES_H
 #define STRUCTURES_H
 
+#include <cstdint>
+#include <cstddef>
+#include <memory>
 #include <string>
+#include <string_view>
 #include "JsonHelper.h"
+#include "JsonWriter.h"
+#include "SizeClassPool.h"
+#include "SmallVector.h"
+#include "SymbolTable.h"
+#include "EntityKey.h"
+#include "CivilDate.h"
 using namespace std;
 
+// Compact JSON of one record, built the first time a response needs it and
+// dropped when the record is persisted again (the managers' logPut and full
+// checkpoints call invalidate()). Readers may race to build it; the fragment is
+// swapped in atomically and never modified afterwards.
+// Copies of a record start without a fragment, so an edited copy assigned back
+// can never bring a stale one with it.
+class JsonFragmentCache {
+public:
+    JsonFragmentCache() = default;
+    JsonFragmentCache(const JsonFragmentCache&) {}
+    JsonFragmentCache& operator=(const JsonFragmentCache&) {
+        invalidate();
+        return *this;
+    }
+
+    template <class Build>
+    shared_ptr<const string> get(Build build) const {
+        shared_ptr<const string> cached = atomic_load(&fragment);
+        if (!cached) {
+            cached = make_shared<const string>(build());
+            atomic_store(&fragment, cached);
+        }
+        return cached;
+    }
+
+    void invalidate() const {
+        atomic_store(&fragment, shared_ptr<const string>());
+    }
+
+private:
+    mutable shared_ptr<const string> fragment;
+};
+
 struct Service {
-    string serviceName;
+    Interned serviceName;
     double price;
     int quantity;
-    Service* next;
     
-    Service(string name, double p, int q);
+    Service(Interned name, double p, int q);
     string toJson() const;
+    void writeJson(JsonWriter& w) const;
+};
+
+// Spill buffers of rooms with more services than fit inline come from one
+// shared SizeClassPool instead of malloc.
+struct ServiceBufferAlloc {
+    static void* allocate(size_t bytes);
+    static void deallocate(void* p, size_t bytes);
+    static SizeClassPool::Stats stats();
 };
 
 struct Room {
-    string roomId;
-    string roomType;
+    RoomKey roomId;
+    Interned roomType;
     double pricePerDay;
-    Service* serviceList;
+    // Newest first; indexes here are the ones the service endpoints use.
+    SmallVector<Service, 5, ServiceBufferAlloc> services;
     bool isAvailable;
+    // Set from the store's version counter each time the record is persisted
+    // (0: unchanged since startup); served as the HTTP ETag.
+    uint64_t revision;
+    JsonFragmentCache jsonCache;
     
     Room();
     Room(string id, string type, double price);
     string toJson() const;
+    void writeJson(JsonWriter& w) const;
+    // Writes the cached compact JSON (Compact style writers only).
+    void writeCachedJson(JsonWriter& w) const;
 };
 
 struct Customer {
-    string customerId;
+    CustomerKey customerId;
     string fullName;
     string idCard;
     string phoneNumber;
-    Customer* next;
+    // Set from the store's version counter each time the record is persisted
+    // (0: unchanged since startup); served as the HTTP ETag.
+    uint64_t revision;
+    JsonFragmentCache jsonCache;
     
     Customer();
     Customer(string id, string name, string card, string phone);
     string toJson() const;
+    void writeJson(JsonWriter& w) const;
+    // Writes the cached compact JSON (Compact style writers only).
+    void writeCachedJson(JsonWriter& w) const;
 };
 
+// Reservation lifecycle, one byte per record. The names ("pending",
+// "checkedIn", "checkedOut", "cancel") are used only in JSON and snapshots.
+enum class ReservationStatus : uint8_t { Pending, CheckedIn, CheckedOut, Cancelled };
+
+const string& reservationStatusName(ReservationStatus status);
+// False, leaving status untouched, for an unknown name.
+bool parseReservationStatus(string_view name, ReservationStatus& status);
+
+// Allowed status changes, [from][to]:
+//   pending   -> checkedIn, cancel
+//   checkedIn -> checkedOut
+// checkedOut and cancel are final.
+constexpr bool RESERVATION_TRANSITIONS[4][4] = {
+    //            pending checkedIn checkedOut cancel
+    /* pending */    {false, true,  false,     true},
+    /* checkedIn */  {false, false, true,      false},
+    /* checkedOut */ {false, false, false,     false},
+    /* cancel */     {false, false, false,     false},
+};
+
+constexpr bool canTransition(ReservationStatus from, ReservationStatus to) {
+    return RESERVATION_TRANSITIONS[static_cast<size_t>(from)][static_cast<size_t>(to)];
+}
+
+// Pending and checked-in reservations hold their room.
+constexpr bool isActiveStatus(ReservationStatus status) {
+    return status == ReservationStatus::Pending || status == ReservationStatus::CheckedIn;
+}
+
 struct Reservation {
     string reservationId;
-    string customerId;
-    string roomId;
-    int checkInDay, checkInMonth, checkInYear;
-    int checkOutDay, checkOutMonth, checkOutYear;
-    string status; // "pending", "checkedIn", "checkedOut"
+    CustomerKey customerId;
+    RoomKey roomId;
+    // Days since 1970-01-01 (CivilDate.h); JSON carries them as day/month/year.
+    DayNumber checkIn;
+    DayNumber checkOut;
+    ReservationStatus status;
+    // Set from the store's version counter each time the record is persisted
+    // (0: unchanged since startup); served as the HTTP ETag.
+    uint64_t revision;
+    JsonFragmentCache jsonCache;
     
     Reservation();
     string toJson() const;
+    void writeJson(JsonWriter& w) const;
+    // Fields only, for responses that add joined fields to the object.
+    void writeFields(JsonWriter& w) const;
+    // Writes the cached compact JSON (Compact style writers only).
+    void writeCachedJson(JsonWriter& w) const;
+    void writeCachedFields(JsonWriter& w) const;
 };
 
 struct Invoice {
     string invoiceId;
-    string customerId;
-    string roomId;
-    int checkInDay, checkInMonth, checkInYear;
-    int checkOutDay, checkOutMonth, checkOutYear;
+    CustomerKey customerId;
+    RoomKey roomId;
+    // Days since 1970-01-01 (CivilDate.h); JSON carries them as day/month/year.
+    DayNumber checkIn;
+    DayNumber checkOut;
     double roomCharge;
     double serviceCharge;
     double totalAmount;
+    // Set from the store's version counter each time the record is persisted
+    // (0: unchanged since startup); served as the HTTP ETag.
+    uint64_t revision;
+    JsonFragmentCache jsonCache;
     
     Invoice();
     string toJson() const;
+    void writeJson(JsonWriter& w) const;
+    // Writes the cached compact JSON (Compact style writers only).
+    void writeCachedJson(JsonWriter& w) const;
 };
 
 #endif
\ No newline at end of file
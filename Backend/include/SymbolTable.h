@@ -0,0 +1,107 @@
+#ifndef SYMBOLTABLE_H
+#define SYMBOLTABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Interned strings for low-cardinality fields (room types, service names)
+// and for entity ids (see EntityKey.h).
+//
+// intern() maps each distinct string to a small integer symbol, so records
+// store 4 bytes instead of a string and equal names compare as integers.
+// Symbols are dense, in order of first intern(), so they can index arrays.
+// With case folding every entry also records the symbol of its lower-cased
+// form: two names match case-insensitively when their folded symbols are equal.
+//
+// Entries are never removed and never move, so name() needs no lock: a
+// symbol only reaches a reader after its entry was published. intern() of a
+// name already in the table only takes the index lock shared; adding a new
+// name takes it exclusively.
+class SymbolTable {
+public:
+    using Symbol = std::uint32_t;
+
+    // Symbol of the empty string.
+    static const Symbol EMPTY = 0;
+
+    // The process-wide table used by Interned.
+    static SymbolTable& global();
+
+    // Without foldCase, folded(s) is s and no lower-cased entries are added.
+    explicit SymbolTable(bool foldCase = true);
+    ~SymbolTable();
+
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    // Throws std::length_error once MAX_SYMBOLS names are interned.
+    Symbol intern(std::string_view name);
+    // Symbol of a name already interned; false, adding nothing, otherwise.
+    // Takes the index lock shared, so concurrent lookups do not serialize.
+    bool find(std::string_view name, Symbol& sym) const;
+    // True if name is interned already or interning it (and its lower-cased
+    // form) keeps the table at or under budget symbols. Callers that intern
+    // client-supplied names give each kind its own budget.
+    bool fitsBudget(std::string_view name, std::size_t budget) const;
+    const std::string& name(Symbol s) const { return entry(s).name; }
+    Symbol folded(Symbol s) const { return entry(s).folded; }
+    std::size_t size() const { return count.load(std::memory_order_acquire); }
+
+private:
+    struct Entry {
+        std::string name;
+        Symbol folded = EMPTY;
+    };
+
+    // Capacity is about 16.7M names over the process lifetime. Nothing is
+    // ever removed: the entity-id dictionaries (EntityKey.h) keep the id of
+    // every room and customer ever created, deleted ones included, and the
+    // managers' key-indexed vectors (slotByKey, handleByKey) grow with them.
+    // Past the limit intern() throws std::length_error; a restart reloads only
+    // the ids still present.
+    static const std::size_t BLOCK_SIZE = 4096;
+    static const std::size_t MAX_BLOCKS = 4096;
+    static const std::size_t MAX_SYMBOLS = BLOCK_SIZE * MAX_BLOCKS;
+
+    const Entry& entry(Symbol s) const {
+        return blocks[s / BLOCK_SIZE].load(std::memory_order_acquire)[s % BLOCK_SIZE];
+    }
+    // Caller holds mtx.
+    Symbol internLocked(std::string_view name);
+
+    std::atomic<Entry*> blocks[MAX_BLOCKS];
+    std::atomic<std::size_t> count;
+    const bool foldCase;
+    mutable std::shared_mutex mtx;
+    // Keys view the names stored in the blocks.
+    std::unordered_map<std::string_view, Symbol> index;
+};
+
+// A string field stored as a SymbolTable::global() symbol.
+class Interned {
+public:
+    Interned() : sym(SymbolTable::EMPTY) {}
+    Interned(std::string_view s) : sym(SymbolTable::global().intern(s)) {}
+    Interned(const std::string& s) : Interned(std::string_view(s)) {}
+    Interned(const char* s) : Interned(std::string_view(s)) {}
+
+    const std::string& str() const { return SymbolTable::global().name(sym); }
+    SymbolTable::Symbol symbol() const { return sym; }
+    // Symbol of the lower-cased name, for case-insensitive matching.
+    SymbolTable::Symbol folded() const { return SymbolTable::global().folded(sym); }
+    bool empty() const { return sym == SymbolTable::EMPTY; }
+
+    bool operator==(const Interned& other) const { return sym == other.sym; }
+    bool operator!=(const Interned& other) const { return sym != other.sym; }
+
+private:
+    SymbolTable::Symbol sym;
+};
+
+#endif
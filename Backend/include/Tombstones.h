@@ -0,0 +1,62 @@
+#ifndef TOMBSTONES_H
+#define TOMBSTONES_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Deleted slots of a manager's record array.
+//
+// Deleting a record only marks its slot and drops its id from the index:
+// later records keep their slots, so nothing shifts and the index is not
+// rebuilt. Scans skip marked slots. Once enough slots are dead, compact()
+// closes the gaps in one stable pass and the owner rebuilds its index once.
+class Tombstones {
+public:
+    // Below this many dead slots compaction is not worth a rebuild.
+    static const int MIN_COMPACT = 64;
+
+    bool isDead(int slot) const {
+        return slot >= 0 && slot < static_cast<int>(dead.size()) && dead[slot];
+    }
+    int count() const { return deadCount; }
+
+    void mark(int slot) {
+        if (isDead(slot)) return;
+        if (slot >= static_cast<int>(dead.size())) dead.resize(slot + 1, 0);
+        dead[slot] = 1;
+        ++deadCount;
+    }
+
+    // True once a quarter of the slots (and at least MIN_COMPACT) are dead.
+    bool compactionDue(int slots) const {
+        return deadCount >= MIN_COMPACT && deadCount * 4 >= slots;
+    }
+
+    // Moves the live records down over the dead slots, keeping their order,
+    // and clears the marks. Returns the number of live records.
+    template <class T>
+    int compact(T* records, int slots) {
+        int live = 0;
+        for (int i = 0; i < slots; ++i) {
+            if (isDead(i)) continue;
+            if (live != i) records[live] = std::move(records[i]);
+            ++live;
+        }
+        for (int i = live; i < slots; ++i) records[i] = T();
+        clear();
+        return live;
+    }
+
+    void clear() {
+        dead.clear();
+        deadCount = 0;
+    }
+
+private:
+    // One byte per slot: 1 = deleted. Slots past the end are live.
+    std::vector<std::uint8_t> dead;
+    int deadCount = 0;
+};
+
+#endif
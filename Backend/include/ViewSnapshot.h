@@ -0,0 +1,53 @@
+#ifndef VIEWSNAPSHOT_H
+#define VIEWSNAPSHOT_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Read-copy-update publication of one list endpoint's response body.
+//
+// The body is an immutable string tagged with the versions of the stores it was
+// rendered from. Readers pick up the current one with a single atomic load and
+// serialize it without holding any store lock; a writer only bumps its store's
+// version and never waits for those readers. The first reader to notice a
+// newer version rebuilds the body under shared store locks and publishes it;
+// readers still sending the old body keep it alive through their shared_ptr.
+class ViewSnapshot {
+public:
+    // stamp() sums the versions of the stores the view is built from. Versions
+    // only grow, so the sum changes whenever any of those stores changes.
+    // lock() returns a guard holding shared locks on the same stores, and
+    // build() renders the body while that guard is held.
+    template <class Stamp, class Lock, class Build>
+    std::shared_ptr<const std::string> get(Stamp stamp, Lock lock, Build build) {
+        std::shared_ptr<const View> view = std::atomic_load(&published);
+        if (view && view->stamp == stamp()) return std::shared_ptr<const std::string>(view, &view->body);
+
+        auto guard = lock();
+        // One rebuild at a time; the others find it published when they get here.
+        std::lock_guard<std::mutex> rebuilding(rebuildMutex);
+        const std::uint64_t current = stamp();
+        view = std::atomic_load(&published);
+        if (!view || view->stamp != current) {
+            auto fresh = std::make_shared<View>();
+            fresh->stamp = current;
+            fresh->body = build();
+            view = fresh;
+            std::atomic_store(&published, view);
+        }
+        return std::shared_ptr<const std::string>(view, &view->body);
+    }
+
+private:
+    struct View {
+        std::uint64_t stamp = 0;
+        std::string body;
+    };
+
+    std::shared_ptr<const View> published;
+    std::mutex rebuildMutex;
+};
+
+#endif
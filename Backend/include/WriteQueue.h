@@ -0,0 +1,99 @@
+#ifndef WRITEQUEUE_H
+#define WRITEQUEUE_H
+
+#include "StoreLocks.h"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+// Single-writer command queue for the mutating endpoints.
+//
+// Once started, HTTP handlers no longer lock the stores for writing
+// themselves. execute() pushes the mutation onto a lock-free MPSC stack and
+// waits. One writer thread takes everything queued so far as one batch,
+// runs it under exclusive locks on every store, and flushes the operation
+// logs once for the whole batch before it answers any handler in it. Readers
+// still take shared locks (StoreLocks) and can run between batches.
+//
+// Until start() is called, execute() runs the mutation inline under the
+// locks it names, which is the default direct mode.
+class WriteQueue {
+public:
+    explicit WriteQueue(const StoreLocks& locks);
+    ~WriteQueue();
+
+    WriteQueue(const WriteQueue&) = delete;
+    WriteQueue& operator=(const WriteQueue&) = delete;
+
+    // Called after each batch, outside the store locks, to make it durable.
+    // Must be called before start().
+    void setFlush(std::function<void()> flush);
+    void start();
+    void stop();
+    bool isRunning() const;
+
+    // Runs body with shared locks on readMask and exclusive locks on writeMask
+    // (direct mode), or on the writer thread (queued mode). Exceptions thrown
+    // by body are rethrown here.
+    template <class F>
+    void execute(unsigned readMask, unsigned writeMask, F body) {
+        if (!isRunning()) {
+            auto guard = locks.lock(readMask, writeMask);
+            body();
+            return;
+        }
+        Command* cmd = new Command(std::function<void()>(std::move(body)));
+        std::future<void> done = cmd->done.get_future();
+        push(cmd);
+        done.get();
+    }
+
+    // Like execute(), for a mutation confined to one room and its
+    // reservations. In direct mode with room shards it only holds that room's
+    // shard exclusively (see StoreLocks::writeRoom).
+    template <class F>
+    void executeForRoom(unsigned mask, const std::string& roomId, F body) {
+        if (!isRunning()) {
+            auto guard = locks.writeRoom(mask, roomId);
+            body();
+            return;
+        }
+        execute(0, mask, std::move(body));
+    }
+
+    // Batches run by the writer thread so far, and the commands in them.
+    std::uint64_t getBatchCount() const;
+    std::uint64_t getCommandCount() const;
+
+private:
+    struct Command {
+        explicit Command(std::function<void()> r) : run(std::move(r)), next(nullptr) {}
+        std::function<void()> run;
+        std::promise<void> done;
+        std::exception_ptr error;
+        Command* next;
+    };
+
+    void push(Command* cmd);
+    Command* takeBatch();
+    void runLoop();
+    void runBatch(Command* batch);
+
+    const StoreLocks& locks;
+    std::function<void()> flush;
+    // Newest command first; the writer swaps the whole stack out and reverses it.
+    std::atomic<Command*> pending;
+    std::atomic<bool> running;
+    std::atomic<std::uint64_t> batches;
+    std::atomic<std::uint64_t> commands;
+
+    std::mutex wakeMtx;
+    std::condition_variable wakeCv;
+    std::thread writer;
+};
+
+#endif
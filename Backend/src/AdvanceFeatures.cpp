@@ -17,7 +17,7 @@ bool RoomCombinationSolver::backtrack(size_t requestIndex) {
         if (room->isAvailable && room->roomType == req.roomType) {
             bool alreadyUsed = false;
             for (Room* used : currentSolution) {
-                if (used->roomId == room->roomId) {
+                if (used == room) {
                     alreadyUsed = true;
                     break;
                 }
@@ -47,6 +47,15 @@ bool RoomCombinationSolver::backtrack(size_t requestIndex) {
 }
 
 bool RoomCombinationSolver::findRoomCombination(const vector<pair<string, int>>& reqs, Room* rooms, int roomCount) {
+    vector<Room*> list;
+    list.reserve(roomCount);
+    for (int i = 0; i < roomCount; i++) {
+        list.push_back(&rooms[i]);
+    }
+    return findRoomCombination(reqs, list);
+}
+
+bool RoomCombinationSolver::findRoomCombination(const vector<pair<string, int>>& reqs, const vector<Room*>& rooms) {
     requests.clear();
     availableRooms.clear();
     solutions.clear();
@@ -56,9 +65,9 @@ bool RoomCombinationSolver::findRoomCombination(const vector<pair<string, int>>&
         requests.push_back({r.first, r.second});
     }
     
-    for (int i = 0; i < roomCount; i++) {
-        if (rooms[i].isAvailable) {
-            availableRooms.push_back(&rooms[i]);
+    for (Room* room : rooms) {
+        if (room->isAvailable) {
+            availableRooms.push_back(room);
         }
     }
     
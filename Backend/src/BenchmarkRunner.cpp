@@ -1,19 +1,53 @@
 #include "AdvanceFeatures.h"
+#include "JsonHelper.h"
+#include "JsonReader.h"
+#include "OperationLog.h"
+#include "ParallelParse.h"
+#include "SlabStore.h"
+#include "StoreLocks.h"
+#include "ViewSnapshot.h"
 #include "Structures.h"
+#include "Tombstones.h"
+#include "WriteQueue.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cctype>
 #include <chrono>
 #include <cstdint>
+#include <cstdlib>
+#include <filesystem>
 #include <iomanip>
 #include <iostream>
+#include <mutex>
+#include <new>
 #include <random>
+#include <shared_mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 using Clock = std::chrono::steady_clock;
 
+// Every operator new in the process, so rows can report allocations.
+static std::atomic<std::uint64_t> g_allocations{0};
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
 namespace {
 
 template <class F>
@@ -29,6 +63,15 @@ double time_ms(F&& fn, int iterations = 1) {
     return elapsed.count() / std::max(1, iterations);
 }
 
+// time_ms that also stores the operator new calls per iteration in allocs.
+template <class F>
+double time_ms_allocs(F&& fn, double& allocs, int iterations = 1) {
+    const std::uint64_t before = g_allocations.load();
+    const double ms = time_ms(fn, iterations);
+    allocs = static_cast<double>(g_allocations.load() - before) / std::max(1, iterations);
+    return ms;
+}
+
 std::string make_id(const char prefix, int width, int value) {
     std::string s;
     s.reserve(static_cast<size_t>(1 + width));
@@ -53,14 +96,163 @@ std::string random_name(std::mt19937_64& rng) {
     return first[d1(rng)] + " " + middle[d2(rng)] + " " + last[d3(rng)];
 }
 
-void print_row(const std::string& name, double ms) {
+void print_row(const std::string& name, double ms, double bytes, double records, double allocs) {
     std::cout << std::left << std::setw(40) << name << std::right << std::setw(12) << std::fixed
-              << std::setprecision(3) << ms << " ms\n";
+              << std::setprecision(3) << ms << " ms";
+    if (bytes > 0 && ms > 0) {
+        std::cout << std::setw(12) << std::setprecision(1) << (bytes / (1024.0 * 1024.0)) / (ms / 1000.0)
+                  << " MB/s";
+    }
+    if (records > 0 && ms > 0) {
+        std::cout << std::setw(14) << std::setprecision(0) << records / (ms / 1000.0) << " rec/s";
+    }
+    if (allocs >= 0) {
+        std::cout << std::setw(12) << std::setprecision(0) << allocs << " allocs";
+    }
+    std::cout << "\n";
 }
 
 struct ResultRow {
     std::string name;
     double ms;
+    double bytes = 0;   // input size, for throughput rows
+    double records = 0; // record count, for records/sec rows
+    double allocs = -1; // operator new calls per run, for allocation rows
+};
+
+// Invoice::toJson as it was before JsonWriter: operator+ chains, to_string and a
+// stringstream per price.
+std::string invoice_to_json_legacy(const Invoice& inv) {
+    std::string json = "  {\n";
+    json += "    \"invoiceId\": \"" + JsonHelper::escapeString(inv.invoiceId) + "\",\n";
+    json += "    \"customerId\": \"" + JsonHelper::escapeString(inv.customerId.str()) + "\",\n";
+    json += "    \"roomId\": \"" + JsonHelper::escapeString(inv.roomId.str()) + "\",\n";
+    const CivilDate in = civilFromDays(inv.checkIn);
+    const CivilDate out = civilFromDays(inv.checkOut);
+    json += "    \"checkInDay\": " + std::to_string(in.day) + ",\n";
+    json += "    \"checkInMonth\": " + std::to_string(in.month) + ",\n";
+    json += "    \"checkInYear\": " + std::to_string(in.year) + ",\n";
+    json += "    \"checkOutDay\": " + std::to_string(out.day) + ",\n";
+    json += "    \"checkOutMonth\": " + std::to_string(out.month) + ",\n";
+    json += "    \"checkOutYear\": " + std::to_string(out.year) + ",\n";
+    json += "    \"roomCharge\": " + JsonHelper::formatPrice(inv.roomCharge) + ",\n";
+    json += "    \"serviceCharge\": " + JsonHelper::formatPrice(inv.serviceCharge) + ",\n";
+    json += "    \"totalAmount\": " + JsonHelper::formatPrice(inv.totalAmount) + "\n";
+    json += "  }";
+    return json;
+}
+
+std::string to_json_array(const std::vector<Reservation>& rows) {
+    std::string json = "[\n";
+    for (size_t i = 0; i < rows.size(); ++i) {
+        json += rows[i].toJson();
+        if (i + 1 < rows.size()) json += ",";
+        json += "\n";
+    }
+    json += "]";
+    return json;
+}
+
+// The loader used before JsonReader: find each {...}, copy it out, then
+// re-scan the object once per key with JsonHelper::extractValue.
+std::uint64_t load_reservations_legacy(const std::string& json, std::vector<Reservation>& out) {
+    out.clear();
+    size_t pos = 1;
+    while (pos < json.length()) {
+        size_t start = json.find("{", pos);
+        if (start == std::string::npos) break;
+        size_t end = json.find("}", start);
+        if (end == std::string::npos) break;
+        std::string obj = json.substr(start, end - start + 1);
+
+        Reservation r;
+        r.reservationId = JsonHelper::extractValue(obj, "reservationId");
+        r.customerId = JsonHelper::extractValue(obj, "customerId");
+        r.roomId = JsonHelper::extractValue(obj, "roomId");
+        r.checkIn = daysFromCivil(std::stoi(JsonHelper::extractValue(obj, "checkInYear")),
+                                  std::stoi(JsonHelper::extractValue(obj, "checkInMonth")),
+                                  std::stoi(JsonHelper::extractValue(obj, "checkInDay")));
+        r.checkOut = daysFromCivil(std::stoi(JsonHelper::extractValue(obj, "checkOutYear")),
+                                   std::stoi(JsonHelper::extractValue(obj, "checkOutMonth")),
+                                   std::stoi(JsonHelper::extractValue(obj, "checkOutDay")));
+        parseReservationStatus(JsonHelper::extractValue(obj, "status"), r.status);
+        out.push_back(std::move(r));
+        pos = end + 1;
+    }
+    return static_cast<std::uint64_t>(out.size());
+}
+
+std::uint64_t load_reservations_reader(std::string_view json, std::vector<Reservation>& out) {
+    out.clear();
+    JsonReader reader(json);
+    JsonField f;
+    std::string status;
+    std::string id;
+    while (reader.nextObject()) {
+        Reservation r;
+        int inD = 0, inM = 0, inY = 0, outD = 0, outM = 0, outY = 0;
+        while (reader.nextField(f)) {
+            if (f.key == "reservationId") JsonReader::toString(f, r.reservationId);
+            else if (f.key == "customerId") {
+                JsonReader::toString(f, id);
+                r.customerId = id;
+            } else if (f.key == "roomId") {
+                JsonReader::toString(f, id);
+                r.roomId = id;
+            }
+            else if (f.key == "checkInDay") JsonReader::toInt(f, inD);
+            else if (f.key == "checkInMonth") JsonReader::toInt(f, inM);
+            else if (f.key == "checkInYear") JsonReader::toInt(f, inY);
+            else if (f.key == "checkOutDay") JsonReader::toInt(f, outD);
+            else if (f.key == "checkOutMonth") JsonReader::toInt(f, outM);
+            else if (f.key == "checkOutYear") JsonReader::toInt(f, outY);
+            else if (f.key == "status") {
+                JsonReader::toString(f, status);
+                parseReservationStatus(status, r.status);
+            }
+        }
+        r.checkIn = daysFromCivil(inY, inM, inD);
+        r.checkOut = daysFromCivil(outY, outM, outD);
+        out.push_back(std::move(r));
+    }
+    return static_cast<std::uint64_t>(out.size());
+}
+
+// A room's services before SmallVector: one heap node per service, hung off
+// a room record laid out as Room was then.
+struct ServiceNode {
+    Service service;
+    ServiceNode* next = nullptr;
+};
+
+struct ListRoom {
+    std::string roomId;
+    std::string roomType;
+    double pricePerDay = 0;
+    ServiceNode* serviceList = nullptr;
+    bool isAvailable = true;
+    std::uint64_t revision = 0;
+    JsonFragmentCache jsonCache;
+};
+
+// Reservation as it was laid out before ReservationStatus: the status held as
+// its JSON name.
+struct StringStatusReservation {
+    std::string reservationId;
+    std::string customerId;
+    std::string roomId;
+    int checkInDay, checkInMonth, checkInYear;
+    int checkOutDay, checkOutMonth, checkOutYear;
+    std::string status;
+    std::uint64_t revision;
+    JsonFragmentCache jsonCache;
+};
+
+// CustomerManager's storage before SlabStore: one heap node per customer,
+// prepended to a singly linked list.
+struct CustomerNode {
+    Customer customer;
+    CustomerNode* next = nullptr;
 };
 
 } // namespace
@@ -69,6 +261,7 @@ int main(int argc, char** argv) {
     int n = 100000;
     int backtrackRooms = 200;
     int repeats = 5;
+    int storeCustomers = 1000000;
     std::uint64_t seed = 42;
 
     for (int i = 1; i < argc; ++i) {
@@ -84,6 +277,8 @@ int main(int argc, char** argv) {
             if (const char* v = next()) backtrackRooms = std::max(1, std::stoi(v));
         } else if (a == "--repeats") {
             if (const char* v = next()) repeats = std::max(1, std::stoi(v));
+        } else if (a == "--customers") {
+            if (const char* v = next()) storeCustomers = std::max(1, std::stoi(v));
         } else if (a == "--seed") {
             if (const char* v = next()) seed = static_cast<std::uint64_t>(std::stoull(v));
         } else if (a == "--help" || a == "-h") {
@@ -91,6 +286,7 @@ int main(int argc, char** argv) {
                       << "  --n <int>                 dataset size (default 100000)\n"
                       << "  --backtrack-rooms <int>   rooms used for backtracking (default 200)\n"
                       << "  --repeats <int>           timing repeats (default 5)\n"
+                      << "  --customers <int>         customers in the store benchmark (default 1000000)\n"
                       << "  --seed <u64>              RNG seed (default 42)\n";
             return 0;
         }
@@ -114,14 +310,13 @@ int main(int argc, char** argv) {
         r.roomType = roomTypes[static_cast<size_t>(typeDist(rng))];
         r.pricePerDay = priceDist(rng);
         r.isAvailable = true;
-        r.serviceList = nullptr;
         rooms.push_back(std::move(r));
     }
 
     roomIndex.reserve(static_cast<size_t>(n) * 2);
     const double buildRoomIndexMs = time_ms([&]() -> std::uint64_t {
         roomIndex.clear();
-        for (int i = 0; i < n; ++i) roomIndex[rooms[i].roomId] = i;
+        for (int i = 0; i < n; ++i) roomIndex[rooms[i].roomId.str()] = i;
         return static_cast<std::uint64_t>(roomIndex.size());
     });
     results.push_back({"rooms: build unordered_map index", buildRoomIndexMs});
@@ -130,15 +325,15 @@ int main(int argc, char** argv) {
         std::vector<Room> tmp = rooms;
         std::sort(tmp.begin(), tmp.end(), [](const Room& a, const Room& b) {
             if (a.pricePerDay != b.pricePerDay) return a.pricePerDay < b.pricePerDay;
-            return a.roomId < b.roomId;
+            return a.roomId.str() < b.roomId.str();
         });
-        return static_cast<std::uint64_t>(tmp[0].roomId.size());
+        return static_cast<std::uint64_t>(tmp[0].roomId.str().size());
     }, repeats);
     results.push_back({"rooms: sort by price (std::sort/introsort)", sortRoomsByPriceMs});
 
     std::vector<std::string> roomQueries;
     roomQueries.reserve(1000);
-    for (int i = 0; i < 1000; ++i) roomQueries.push_back(rooms[idDist(rng)].roomId);
+    for (int i = 0; i < 1000; ++i) roomQueries.push_back(rooms[idDist(rng)].roomId.str());
 
     const double hashLookupRoomsMs = time_ms([&]() -> std::uint64_t {
         std::uint64_t hits = 0;
@@ -149,6 +344,189 @@ int main(int argc, char** argv) {
     }, repeats);
     results.push_back({"rooms: hash lookup 1000 ids", hashLookupRoomsMs});
 
+    // -------------------- Rooms: shift + rebuild vs tombstones --------------------
+
+    // 20 deletes by id from a copy of the rooms. The old path shifts every
+    // later room down and rehashes the whole index per delete; a tombstone
+    // marks the slot and erases one key. One compaction pass then restores
+    // contiguity and rebuilds the index.
+    {
+        std::vector<std::string> deleteIds;
+        for (int i = 0; i < 20; ++i) {
+            deleteIds.push_back(make_id('R', 6, static_cast<int>((static_cast<std::uint64_t>(i) * 7919) % static_cast<std::uint64_t>(n))));
+        }
+
+        std::vector<Room> shifted = rooms;
+        std::unordered_map<std::string, int> shiftedIndex = roomIndex;
+        int shiftedCount = n;
+        const double shiftDeleteMs = time_ms([&]() -> std::uint64_t {
+            std::uint64_t deleted = 0;
+            for (const std::string& id : deleteIds) {
+                auto it = shiftedIndex.find(id);
+                if (it == shiftedIndex.end()) continue;
+                for (int i = it->second; i < shiftedCount - 1; ++i) shifted[i] = std::move(shifted[i + 1]);
+                shifted[--shiftedCount] = Room();
+                shiftedIndex.clear();
+                for (int i = 0; i < shiftedCount; ++i) shiftedIndex[shifted[i].roomId.str()] = i;
+                ++deleted;
+            }
+            return deleted;
+        });
+        results.push_back({"rooms: delete 20 ids, shift + rebuild", shiftDeleteMs});
+
+        std::vector<Room> marked = rooms;
+        std::unordered_map<std::string, int> markedIndex = roomIndex;
+        Tombstones tombstones;
+        const double tombstoneDeleteMs = time_ms([&]() -> std::uint64_t {
+            std::uint64_t deleted = 0;
+            for (const std::string& id : deleteIds) {
+                auto it = markedIndex.find(id);
+                if (it == markedIndex.end()) continue;
+                const int slot = it->second;
+                markedIndex.erase(it);
+                marked[slot] = Room();
+                tombstones.mark(slot);
+                ++deleted;
+            }
+            return deleted;
+        });
+        results.push_back({"rooms: delete 20 ids, tombstone", tombstoneDeleteMs});
+
+        const double compactMs = time_ms([&]() -> std::uint64_t {
+            const int live = tombstones.compact(marked.data(), n);
+            markedIndex.clear();
+            for (int i = 0; i < live; ++i) markedIndex[marked[i].roomId.str()] = i;
+            return static_cast<std::uint64_t>(live);
+        });
+        results.push_back({"rooms: compact 20 tombstones + index", compactMs});
+    }
+
+    // -------------------- Services: linked list vs SmallVector --------------------
+
+    // Every room gets 0-5 services, added in rounds across all rooms the way
+    // requests add them over a stay, so one room's list nodes are not
+    // neighbours on the heap. "build + free" fills and tears down all of them;
+    // "charge" sums price * quantity per room, as checkout and
+    // /api/service/rooms do.
+    {
+        static const char* const serviceNames[] = {"Spa", "Laundry", "Breakfast", "Minibar", "Taxi"};
+        const double roomCount = static_cast<double>(n);
+        std::vector<ListRoom> listRooms(static_cast<size_t>(n));
+        auto freeLists = [&]() {
+            for (ListRoom& room : listRooms) {
+                ServiceNode*& head = room.serviceList;
+                while (head) {
+                    ServiceNode* next = head->next;
+                    delete head;
+                    head = next;
+                }
+            }
+        };
+        double listBuildAllocs = 0;
+        const double listBuildMs = time_ms_allocs([&]() -> std::uint64_t {
+            freeLists();
+            std::uint64_t nodes = 0;
+            for (int k = 0; k < 5; ++k) {
+                for (int i = 0; i < n; ++i) {
+                    if (k >= i % 6) continue;
+                    ServiceNode* node = new ServiceNode{Service(serviceNames[k], 10.0 + k, 1 + k)};
+                    node->next = listRooms[static_cast<size_t>(i)].serviceList;
+                    listRooms[static_cast<size_t>(i)].serviceList = node;
+                    ++nodes;
+                }
+            }
+            return nodes;
+        }, listBuildAllocs, repeats);
+        results.push_back({"services: linked list build + free", listBuildMs, 0, roomCount, listBuildAllocs});
+        const double listChargeMs = time_ms([&]() -> std::uint64_t {
+            double total = 0;
+            for (const ListRoom& room : listRooms) {
+                for (const ServiceNode* s = room.serviceList; s; s = s->next) total += s->service.price * s->service.quantity;
+            }
+            return static_cast<std::uint64_t>(total);
+        }, repeats);
+        results.push_back({"services: linked list charge", listChargeMs, 0, roomCount});
+        freeLists();
+
+        std::vector<Room> serviceRooms(static_cast<size_t>(n));
+        double vectorBuildAllocs = 0;
+        const double vectorBuildMs = time_ms_allocs([&]() -> std::uint64_t {
+            std::uint64_t entries = 0;
+            for (Room& room : serviceRooms) room.services.clear();
+            for (int k = 0; k < 5; ++k) {
+                for (int i = 0; i < n; ++i) {
+                    if (k >= i % 6) continue;
+                    serviceRooms[static_cast<size_t>(i)].services.insert(0, Service(serviceNames[k], 10.0 + k, 1 + k));
+                    ++entries;
+                }
+            }
+            return entries;
+        }, vectorBuildAllocs, repeats);
+        results.push_back({"services: SmallVector build + free", vectorBuildMs, 0, roomCount, vectorBuildAllocs});
+        const double vectorChargeMs = time_ms([&]() -> std::uint64_t {
+            double total = 0;
+            for (const Room& room : serviceRooms) {
+                for (const Service& svc : room.services) total += svc.price * svc.quantity;
+            }
+            return static_cast<std::uint64_t>(total);
+        }, repeats);
+        results.push_back({"services: SmallVector charge", vectorChargeMs, 0, roomCount});
+
+        // addServiceToRoom's case-insensitive name match over every room's
+        // services: lower-cased copies of both names per compare (as before
+        // interning) vs the folded symbols.
+        auto normalize = [](const std::string& str) {
+            std::string out = str;
+            std::transform(out.begin(), out.end(), out.begin(), [](unsigned char c) {
+                return static_cast<char>(std::tolower(c));
+            });
+            return out;
+        };
+        const std::string wanted = "LAUNDRY";
+        const double normalizeMatchMs = time_ms([&]() -> std::uint64_t {
+            const std::string key = normalize(wanted);
+            std::uint64_t hits = 0;
+            for (const Room& room : serviceRooms) {
+                for (const Service& svc : room.services) hits += normalize(svc.serviceName.str()) == key;
+            }
+            return hits;
+        }, repeats);
+        results.push_back({"services: name match, lower-case copies", normalizeMatchMs, 0, roomCount});
+        const double symbolMatchMs = time_ms([&]() -> std::uint64_t {
+            const SymbolTable::Symbol key = Interned(wanted).folded();
+            std::uint64_t hits = 0;
+            for (const Room& room : serviceRooms) {
+                for (const Service& svc : room.services) hits += svc.serviceName.folded() == key;
+            }
+            return hits;
+        }, repeats);
+        results.push_back({"services: name match, folded symbols", symbolMatchMs, 0, roomCount});
+
+        // Rooms with 8 services spill out of the inline buffer. Spill buffers
+        // from the heap cost a malloc each time; from the pool (what Room uses)
+        // they are reused after the first round.
+        auto spillRounds = [&](auto& lists, double& allocs) {
+            return time_ms_allocs([&]() -> std::uint64_t {
+                std::uint64_t entries = 0;
+                for (auto& list : lists) {
+                    list.clear();
+                    for (int k = 0; k < 8; ++k) list.emplace_back(serviceNames[k % 5], 10.0 + k, 1 + k);
+                    entries += list.size();
+                }
+                for (auto& list : lists) list = {};
+                return entries;
+            }, allocs, repeats);
+        };
+        std::vector<SmallVector<Service, 5>> heapSpill(static_cast<size_t>(n));
+        double heapSpillAllocs = 0;
+        const double heapSpillMs = spillRounds(heapSpill, heapSpillAllocs);
+        results.push_back({"services: 8/room, heap spill", heapSpillMs, 0, roomCount, heapSpillAllocs});
+        std::vector<SmallVector<Service, 5, ServiceBufferAlloc>> poolSpill(static_cast<size_t>(n));
+        double poolSpillAllocs = 0;
+        const double poolSpillMs = spillRounds(poolSpill, poolSpillAllocs);
+        results.push_back({"services: 8/room, SizeClassPool spill", poolSpillMs, 0, roomCount, poolSpillAllocs});
+    }
+
     // -------------------- Customers: sort + search --------------------
     std::vector<Customer> customers;
     std::unordered_map<std::string, int> customerIndex;
@@ -160,7 +538,6 @@ int main(int argc, char** argv) {
         c.fullName = random_name(rng);
         c.idCard = make_id('I', 8, i);
         c.phoneNumber = "09" + make_id('0', 8, i).substr(1);
-        c.next = nullptr;
         customers.push_back(std::move(c));
     }
 
@@ -168,7 +545,7 @@ int main(int argc, char** argv) {
         std::vector<Customer> tmp = customers;
         std::sort(tmp.begin(), tmp.end(), [](const Customer& a, const Customer& b) {
             if (a.fullName != b.fullName) return a.fullName < b.fullName;
-            return a.customerId < b.customerId;
+            return a.customerId.str() < b.customerId.str();
         });
         return static_cast<std::uint64_t>(tmp[0].fullName.size());
     }, repeats);
@@ -177,14 +554,14 @@ int main(int argc, char** argv) {
     customerIndex.reserve(static_cast<size_t>(n) * 2);
     const double buildCustomerIndexMs = time_ms([&]() -> std::uint64_t {
         customerIndex.clear();
-        for (int i = 0; i < n; ++i) customerIndex[customers[i].customerId] = i;
+        for (int i = 0; i < n; ++i) customerIndex[customers[i].customerId.str()] = i;
         return static_cast<std::uint64_t>(customerIndex.size());
     });
     results.push_back({"customers: build unordered_map index", buildCustomerIndexMs});
 
     std::vector<std::string> customerQueries;
     customerQueries.reserve(1000);
-    for (int i = 0; i < 1000; ++i) customerQueries.push_back(customers[idDist(rng)].customerId);
+    for (int i = 0; i < 1000; ++i) customerQueries.push_back(customers[idDist(rng)].customerId.str());
 
     const double hashLookupCustomersMs = time_ms([&]() -> std::uint64_t {
         std::uint64_t hits = 0;
@@ -195,26 +572,117 @@ int main(int argc, char** argv) {
     }, repeats);
     results.push_back({"customers: hash lookup 1000 ids", hashLookupCustomersMs});
 
+    // -------------------- Customers: linked list vs SlabStore --------------------
+
+    // CustomerManager storage at --customers records: build with the id index,
+    // one full scan (what GET /api/customers does), and 100 deletes by id.
+    // The list has to walk to the node before it can unlink it.
+    {
+        const double customerCount = static_cast<double>(storeCustomers);
+        std::vector<std::string> deleteIds;
+        for (int i = 0; i < 100; ++i) {
+            deleteIds.push_back(make_id('C', 7, static_cast<int>((static_cast<std::uint64_t>(i) * 7919) % static_cast<std::uint64_t>(storeCustomers))));
+        }
+        auto makeCustomer = [](int i) {
+            return Customer(make_id('C', 7, i), "Nguyen Van " + std::to_string(i % 997), make_id('I', 9, i),
+                            "09" + make_id('0', 8, i).substr(1));
+        };
+
+        CustomerNode* head = nullptr;
+        std::unordered_map<std::string, CustomerNode*> listIndex;
+        double listBuildAllocs = 0;
+        const double listBuildMs = time_ms_allocs([&]() -> std::uint64_t {
+            listIndex.reserve(static_cast<size_t>(storeCustomers));
+            for (int i = 0; i < storeCustomers; ++i) {
+                CustomerNode* node = new CustomerNode{makeCustomer(i)};
+                node->next = head;
+                head = node;
+                listIndex[node->customer.customerId.str()] = node;
+            }
+            return listIndex.size();
+        }, listBuildAllocs);
+        results.push_back({"customers: linked list build + index", listBuildMs, 0, customerCount, listBuildAllocs});
+        const double listScanMs = time_ms([&]() -> std::uint64_t {
+            std::uint64_t bytes = 0;
+            for (CustomerNode* c = head; c; c = c->next) bytes += c->customer.fullName.size();
+            return bytes;
+        }, repeats);
+        results.push_back({"customers: linked list scan", listScanMs, 0, customerCount});
+        double listDeleteAllocs = 0;
+        const double listDeleteMs = time_ms_allocs([&]() -> std::uint64_t {
+            std::uint64_t deleted = 0;
+            for (const std::string& id : deleteIds) {
+                if (listIndex.erase(id) == 0) continue;
+                CustomerNode* prev = nullptr;
+                for (CustomerNode* c = head; c; prev = c, c = c->next) {
+                    if (c->customer.customerId.str() != id) continue;
+                    (prev ? prev->next : head) = c->next;
+                    delete c;
+                    ++deleted;
+                    break;
+                }
+            }
+            return deleted;
+        }, listDeleteAllocs);
+        results.push_back({"customers: linked list delete 100 ids", listDeleteMs, 0, 0, listDeleteAllocs});
+        while (head) {
+            CustomerNode* next = head->next;
+            delete head;
+            head = next;
+        }
+        listIndex = {};
+
+        SlabStore<Customer> slab;
+        std::unordered_map<std::string, SlabStore<Customer>::Handle> slabIndex;
+        double slabBuildAllocs = 0;
+        const double slabBuildMs = time_ms_allocs([&]() -> std::uint64_t {
+            slabIndex.reserve(static_cast<size_t>(storeCustomers));
+            slab.reserve(static_cast<size_t>(storeCustomers));
+            for (int i = 0; i < storeCustomers; ++i) {
+                Customer c = makeCustomer(i);
+                const std::string id = c.customerId.str();
+                slabIndex[id] = slab.insert(std::move(c));
+            }
+            return slabIndex.size();
+        }, slabBuildAllocs);
+        results.push_back({"customers: SlabStore build + index", slabBuildMs, 0, customerCount, slabBuildAllocs});
+        const double slabScanMs = time_ms([&]() -> std::uint64_t {
+            std::uint64_t bytes = 0;
+            slab.forEach([&bytes](const Customer& c) { bytes += c.fullName.size(); });
+            return bytes;
+        }, repeats);
+        results.push_back({"customers: SlabStore scan", slabScanMs, 0, customerCount});
+        double slabDeleteAllocs = 0;
+        const double slabDeleteMs = time_ms_allocs([&]() -> std::uint64_t {
+            std::uint64_t deleted = 0;
+            for (const std::string& id : deleteIds) {
+                auto it = slabIndex.find(id);
+                if (it == slabIndex.end()) continue;
+                slab.erase(it->second);
+                slabIndex.erase(it);
+                ++deleted;
+            }
+            return deleted;
+        }, slabDeleteAllocs);
+        results.push_back({"customers: SlabStore delete 100 ids", slabDeleteMs, 0, 0, slabDeleteAllocs});
+    }
+
     // -------------------- Reservations: index + active map (server join) --------------------
 
     std::vector<Reservation> reservations;
     reservations.reserve(static_cast<size_t>(n));
 
-    static const std::vector<std::string> statuses = {"pending", "checkedIn", "checkedOut", "cancel"};
-    std::uniform_int_distribution<int> statusDist(0, static_cast<int>(statuses.size() - 1));
+    std::uniform_int_distribution<int> statusDist(0, 3);
 
     for (int i = 0; i < n; ++i) {
         Reservation r;
         r.reservationId = make_id('S', 7, i);
         r.customerId = customers[static_cast<size_t>(i)].customerId;
         r.roomId = rooms[static_cast<size_t>(i)].roomId;
-        r.checkInDay = 1;
-        r.checkInMonth = 1;
-        r.checkInYear = 2026;
-        r.checkOutDay = 2;
-        r.checkOutMonth = 1;
-        r.checkOutYear = 2026;
-        r.status = statuses[static_cast<size_t>(statusDist(rng))];
+        // Stays of 1-7 nights spread over 2025-2026.
+        r.checkIn = daysFromCivil(2025, 1, 1) + (i * 37) % 730;
+        r.checkOut = r.checkIn + 1 + i % 7;
+        r.status = static_cast<ReservationStatus>(statusDist(rng));
         reservations.push_back(std::move(r));
     }
 
@@ -247,14 +715,173 @@ int main(int argc, char** argv) {
         activeByRoomId.clear();
         for (int i = 0; i < n; ++i) {
             const auto& r = reservations[i];
-            if (r.status == "pending" || r.status == "checkedIn") {
-                activeByRoomId[r.roomId] = i;
+            if (isActiveStatus(r.status)) {
+                activeByRoomId[r.roomId.str()] = i;
             }
         }
         return static_cast<std::uint64_t>(activeByRoomId.size());
     }, repeats);
     results.push_back({"reservations: build activeMap(roomId->reservation)", buildActiveMapMs});
 
+    // The /api/reservations join: every reservation's customer name. With
+    // string ids each row hashes its customerId through the customer index;
+    // with surrogate keys the CustomerKey indexes a slot array directly.
+    {
+        std::vector<std::string> customerIdStrings;
+        customerIdStrings.reserve(reservations.size());
+        for (const Reservation& r : reservations) customerIdStrings.push_back(r.customerId.str());
+        std::vector<int> customerSlotByKey(CustomerIds::dictionary().size(), -1);
+        for (int i = 0; i < n; ++i) customerSlotByKey[customers[i].customerId.index()] = i;
+
+        const double stringJoinMs = time_ms([&]() -> std::uint64_t {
+            std::uint64_t bytes = 0;
+            for (const std::string& id : customerIdStrings) {
+                auto it = customerIndex.find(id);
+                if (it != customerIndex.end()) bytes += customers[static_cast<size_t>(it->second)].fullName.size();
+            }
+            return bytes;
+        }, repeats);
+        results.push_back({"reservations: customer join, string hash", stringJoinMs, 0, static_cast<double>(n)});
+        const double keyJoinMs = time_ms([&]() -> std::uint64_t {
+            std::uint64_t bytes = 0;
+            for (const Reservation& r : reservations) {
+                const int slot = customerSlotByKey[r.customerId.index()];
+                if (slot >= 0) bytes += customers[static_cast<size_t>(slot)].fullName.size();
+            }
+            return bytes;
+        }, repeats);
+        results.push_back({"reservations: customer join, key index", keyJoinMs, 0, static_cast<double>(n)});
+    }
+
+    // The scan findReservationByRoom and deleteReservation do: count the
+    // active reservations of 100 rooms, status compared first. Records with
+    // the status as a string are larger and each check is a string compare.
+    {
+        std::vector<StringStatusReservation> stringReservations;
+        stringReservations.reserve(reservations.size());
+        for (const Reservation& r : reservations) {
+            StringStatusReservation legacy;
+            legacy.reservationId = r.reservationId;
+            legacy.customerId = r.customerId.str();
+            legacy.roomId = r.roomId.str();
+            const CivilDate in = civilFromDays(r.checkIn);
+            const CivilDate out = civilFromDays(r.checkOut);
+            legacy.checkInDay = in.day;
+            legacy.checkInMonth = in.month;
+            legacy.checkInYear = in.year;
+            legacy.checkOutDay = out.day;
+            legacy.checkOutMonth = out.month;
+            legacy.checkOutYear = out.year;
+            legacy.status = reservationStatusName(r.status);
+            legacy.revision = 0;
+            stringReservations.push_back(std::move(legacy));
+        }
+        std::vector<std::string> scanRooms;
+        std::vector<RoomKey> scanKeys;
+        for (int i = 0; i < 100; ++i) {
+            scanKeys.push_back(rooms[static_cast<size_t>(idDist(rng))].roomId);
+            scanRooms.push_back(scanKeys.back().str());
+        }
+        const double scanCount = static_cast<double>(n) * static_cast<double>(scanRooms.size());
+
+        const double stringScanMs = time_ms([&]() -> std::uint64_t {
+            std::uint64_t active = 0;
+            for (const std::string& roomId : scanRooms) {
+                for (const StringStatusReservation& r : stringReservations) {
+                    if ((r.status == "pending" || r.status == "checkedIn") && r.roomId == roomId) ++active;
+                }
+            }
+            return active;
+        }, repeats);
+        results.push_back({"reservations: active scan, string status (" + std::to_string(sizeof(StringStatusReservation)) + " B)",
+                           stringScanMs, 0, scanCount});
+        const double enumScanMs = time_ms([&]() -> std::uint64_t {
+            std::uint64_t active = 0;
+            for (RoomKey roomId : scanKeys) {
+                for (const Reservation& r : reservations) {
+                    if (isActiveStatus(r.status) && r.roomId == roomId) ++active;
+                }
+            }
+            return active;
+        }, repeats);
+        results.push_back({"reservations: active scan, enum status (" + std::to_string(sizeof(Reservation)) + " B)",
+                           enumScanMs, 0, scanCount});
+
+        // What ReservationManager keeps instead of scanning: each room's
+        // active slots, by RoomKey. Lookups read one short list per room.
+        std::vector<SmallVector<int, 2>> activeByRoom(RoomIds::dictionary().size());
+        for (int i = 0; i < n; ++i) {
+            if (isActiveStatus(reservations[i].status)) activeByRoom[reservations[i].roomId.index()].push_back(i);
+        }
+        const double indexLookupMs = time_ms([&]() -> std::uint64_t {
+            std::uint64_t active = 0;
+            for (RoomKey roomId : scanKeys) active += activeByRoom[roomId.index()].size();
+            return active;
+        }, repeats);
+        results.push_back({"reservations: active lookup, per-room index", indexLookupMs});
+
+        // Date work over every reservation: count the stays overlapping July
+        // 2025 and total their nights. With y/m/d fields the range test is a
+        // three-level comparison per endpoint and nights need the civil
+        // conversion; day numbers make both plain integer operations.
+        const int fromY = 2025, fromM = 7, fromD = 1;
+        const int toY = 2025, toM = 8, toD = 1;
+        auto before = [](int y1, int m1, int d1, int y2, int m2, int d2) {
+            if (y1 != y2) return y1 < y2;
+            if (m1 != m2) return m1 < m2;
+            return d1 < d2;
+        };
+        const double fieldDatesMs = time_ms([&]() -> std::uint64_t {
+            std::uint64_t nights = 0;
+            for (const StringStatusReservation& r : stringReservations) {
+                if (before(r.checkInYear, r.checkInMonth, r.checkInDay, toY, toM, toD) &&
+                    before(fromY, fromM, fromD, r.checkOutYear, r.checkOutMonth, r.checkOutDay)) {
+                    nights += static_cast<std::uint64_t>(daysFromCivil(r.checkOutYear, r.checkOutMonth, r.checkOutDay) -
+                                                         daysFromCivil(r.checkInYear, r.checkInMonth, r.checkInDay));
+                }
+            }
+            return nights;
+        }, repeats);
+        results.push_back({"reservations: July stays + nights, y/m/d", fieldDatesMs, 0, static_cast<double>(n)});
+        const DayNumber from = daysFromCivil(fromY, fromM, fromD);
+        const DayNumber to = daysFromCivil(toY, toM, toD);
+        const double dayNumberMs = time_ms([&]() -> std::uint64_t {
+            std::uint64_t nights = 0;
+            for (const Reservation& r : reservations) {
+                if (r.checkIn < to && from < r.checkOut) nights += static_cast<std::uint64_t>(r.checkOut - r.checkIn);
+            }
+            return nights;
+        }, repeats);
+        results.push_back({"reservations: July stays + nights, day numbers", dayNumberMs, 0, static_cast<double>(n)});
+    }
+
+    // Parse reservations.json-shaped text: legacy per-key rescans vs single-pass reader.
+    const std::string reservationJson = to_json_array(reservations);
+    const double jsonBytes = static_cast<double>(reservationJson.size());
+    std::vector<Reservation> parsed;
+    parsed.reserve(static_cast<size_t>(n));
+
+    const double legacyLoadMs = time_ms([&]() -> std::uint64_t {
+        return load_reservations_legacy(reservationJson, parsed);
+    });
+    results.push_back({"json: load reservations (extractValue)", legacyLoadMs, jsonBytes});
+
+    const double readerLoadMs = time_ms([&]() -> std::uint64_t {
+        return load_reservations_reader(reservationJson, parsed);
+    }, repeats);
+    results.push_back({"json: load reservations (JsonReader)", readerLoadMs, jsonBytes});
+
+    ThreadPool parsePool;
+    const double chunkedLoadMs = time_ms([&]() -> std::uint64_t {
+        auto parts = parseJsonArrayChunks<Reservation>(reservationJson, &parsePool,
+            [](std::string_view chunk, std::vector<Reservation>& out) { load_reservations_reader(chunk, out); });
+        std::uint64_t total = 0;
+        for (const auto& part : parts) total += part.size();
+        return total;
+    }, repeats);
+    results.push_back({"json: load reservations (chunked, " + std::to_string(parsePool.size()) + " threads)",
+                       chunkedLoadMs, jsonBytes});
+
     // -------------------- Invoices: sort by totalAmount --------------------
 
     std::vector<Invoice> invoices;
@@ -264,7 +891,13 @@ int main(int argc, char** argv) {
     for (int i = 0; i < n; ++i) {
         Invoice inv;
         inv.invoiceId = make_id('V', 7, i);
-        inv.totalAmount = amountDist(rng);
+        inv.customerId = customers[static_cast<size_t>(i)].customerId;
+        inv.roomId = rooms[static_cast<size_t>(i)].roomId;
+        inv.checkIn = daysFromCivil(2026, 1, 1);
+        inv.checkOut = daysFromCivil(2026, 1, 2);
+        inv.roomCharge = amountDist(rng);
+        inv.serviceCharge = amountDist(rng);
+        inv.totalAmount = inv.roomCharge + inv.serviceCharge;
         invoices.push_back(std::move(inv));
     }
 
@@ -278,6 +911,238 @@ int main(int argc, char** argv) {
     }, repeats);
     results.push_back({"invoices: sort by totalAmount desc", sortInvoicesDescMs});
 
+    // Serialize every invoice as the data file does: legacy string building vs JsonWriter.
+    const double records = static_cast<double>(n);
+    std::string out;
+    const double legacyWriteMs = time_ms([&]() -> std::uint64_t {
+        out.clear();
+        out += "[\n";
+        for (int i = 0; i < n; ++i) {
+            out += invoice_to_json_legacy(invoices[static_cast<size_t>(i)]);
+            out += (i < n - 1) ? ",\n" : "\n";
+        }
+        out += "]\n";
+        return static_cast<std::uint64_t>(out.size());
+    });
+    results.push_back({"json: write invoices (string concat)", legacyWriteMs, 0, records});
+
+    const double writerFileMs = time_ms([&]() -> std::uint64_t {
+        out.clear();
+        JsonWriter w(out, JsonWriter::Style::File);
+        w.beginArray();
+        for (const Invoice& inv : invoices) inv.writeJson(w);
+        w.endArray();
+        return static_cast<std::uint64_t>(out.size());
+    }, repeats);
+    results.push_back({"json: write invoices (JsonWriter file)", writerFileMs, 0, records});
+
+    const double writerCompactMs = time_ms([&]() -> std::uint64_t {
+        out.clear();
+        JsonWriter w(out);
+        w.beginArray();
+        for (const Invoice& inv : invoices) inv.writeJson(w);
+        w.endArray();
+        return static_cast<std::uint64_t>(out.size());
+    }, repeats);
+    results.push_back({"json: write invoices (JsonWriter http)", writerCompactMs, 0, records});
+
+    // GET /api/invoices once the per-record fragments are warm.
+    for (const Invoice& inv : invoices) {
+        std::string warm;
+        JsonWriter w(warm);
+        inv.writeCachedJson(w);
+    }
+    const double cachedListMs = time_ms([&]() -> std::uint64_t {
+        out.clear();
+        JsonWriter w(out);
+        w.beginArray();
+        for (const Invoice& inv : invoices) inv.writeCachedJson(w);
+        w.endArray();
+        return static_cast<std::uint64_t>(out.size());
+    }, repeats);
+    results.push_back({"json: list invoices (cached fragments)", cachedListMs, 0, records});
+
+    // -------------------- Concurrency: GET /api/rooms under store locks --------------------
+
+    // Each thread serves list requests over the same rooms; one request in 50 is a
+    // price update. The baseline serializes everything on one std::mutex, the way a
+    // single global lock would; StoreLocks lets the GETs share the rooms lock, and
+    // ViewSnapshot serves a published body with no lock until a write lands.
+    const int listRooms = std::min(n, 1000);
+    for (int i = 0; i < listRooms; ++i) {
+        std::string warm;
+        JsonWriter w(warm);
+        rooms[static_cast<size_t>(i)].writeCachedJson(w);
+    }
+    const int requestsPerThread = 400;
+    auto renderRooms = [&]() {
+        std::string body;
+        JsonWriter w(body);
+        w.beginArray();
+        for (int i = 0; i < listRooms; ++i) rooms[static_cast<size_t>(i)].writeCachedJson(w);
+        w.endArray();
+        return body;
+    };
+    auto updateRoom = [&](int r, unsigned t) {
+        Room& room = rooms[static_cast<size_t>((r + static_cast<int>(t)) % listRooms)];
+        room.pricePerDay += 1.0;
+        room.jsonCache.invalidate();
+    };
+    // serve() answers one GET and returns the body size; update(r, t) is one write.
+    auto serveRooms = [&](unsigned threads, auto serve, auto update) -> std::uint64_t {
+        std::vector<std::thread> workers;
+        std::vector<std::uint64_t> bytes(threads, 0);
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                for (int r = 0; r < requestsPerThread; ++r) {
+                    if (r % 50 == 49) update(r, t);
+                    else bytes[t] += serve();
+                }
+            });
+        }
+        for (auto& worker : workers) worker.join();
+        std::uint64_t total = 0;
+        for (std::uint64_t b : bytes) total += b;
+        return total;
+    };
+
+    std::mutex globalMutex;
+    std::shared_mutex storeMutexes[StoreLocks::COUNT];
+    StoreLocks locks(storeMutexes[0], storeMutexes[1], storeMutexes[2], storeMutexes[3]);
+    std::atomic<std::uint64_t> roomsVersion{0};
+    ViewSnapshot roomsView;
+    for (unsigned threads : {1u, 2u, 4u, 8u}) {
+        const double requests = static_cast<double>(threads) * requestsPerThread;
+        const std::string suffix = " x" + std::to_string(threads);
+        const double exclusiveMs = time_ms([&]() -> std::uint64_t {
+            return serveRooms(threads,
+                              [&]() {
+                                  std::lock_guard<std::mutex> lock(globalMutex);
+                                  return renderRooms().size();
+                              },
+                              [&](int r, unsigned t) {
+                                  std::lock_guard<std::mutex> lock(globalMutex);
+                                  updateRoom(r, t);
+                              });
+        });
+        results.push_back({"locks: list rooms, std::mutex" + suffix, exclusiveMs, 0, requests});
+        const double sharedMs = time_ms([&]() -> std::uint64_t {
+            return serveRooms(threads,
+                              [&]() {
+                                  auto guard = locks.read(StoreLocks::Rooms);
+                                  return renderRooms().size();
+                              },
+                              [&](int r, unsigned t) {
+                                  auto guard = locks.write(StoreLocks::Rooms);
+                                  updateRoom(r, t);
+                              });
+        });
+        results.push_back({"locks: list rooms, StoreLocks" + suffix, sharedMs, 0, requests});
+        const double viewMs = time_ms([&]() -> std::uint64_t {
+            return serveRooms(threads,
+                              [&]() {
+                                  return roomsView.get([&]() { return roomsVersion.load(); },
+                                                       [&]() { return locks.read(StoreLocks::Rooms); },
+                                                       renderRooms)->size();
+                              },
+                              [&](int r, unsigned t) {
+                                  auto guard = locks.write(StoreLocks::Rooms);
+                                  updateRoom(r, t);
+                                  ++roomsVersion;
+                              });
+        });
+        results.push_back({"locks: list rooms, ViewSnapshot" + suffix, viewMs, 0, requests});
+    }
+
+    // -------------------- Writes: per-request commit vs single-writer queue --------------------
+
+    // Every write updates a room and appends it to an operation log synced per
+    // batch. Direct mode commits (and fsyncs) each request on its own; the queue
+    // runs whatever piled up as one batch with one flush.
+    const std::string logPath = (std::filesystem::temp_directory_path() / "benchmark_writes.log").string();
+    const int writesPerThread = 200;
+    auto writeRooms = [&](unsigned threads, OperationLog& log, WriteQueue& queue) -> std::uint64_t {
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                for (int r = 0; r < writesPerThread; ++r) {
+                    queue.execute(0, StoreLocks::Rooms, [&]() {
+                        Room& room = rooms[static_cast<size_t>((r * 7 + static_cast<int>(t)) % listRooms)];
+                        room.pricePerDay += 1.0;
+                        log.appendPut(room.roomId.str(), room.toJson());
+                    });
+                }
+            });
+        }
+        for (auto& worker : workers) worker.join();
+        return static_cast<std::uint64_t>(log.getRecordCount());
+    };
+    for (unsigned threads : {1u, 4u, 8u}) {
+        const double requests = static_cast<double>(threads) * writesPerThread;
+        const std::string suffix = " x" + std::to_string(threads);
+        std::uint64_t batches = 0;
+        const double directMs = time_ms([&]() -> std::uint64_t {
+            OperationLog log(logPath);
+            log.setDurability(Durability::FsyncPerBatch);
+            log.truncate();
+            WriteQueue direct(locks);
+            return writeRooms(threads, log, direct);
+        });
+        results.push_back({"writes: direct commit" + suffix, directMs, 0, requests});
+        const double queuedMs = time_ms([&]() -> std::uint64_t {
+            OperationLog log(logPath);
+            log.setDurability(Durability::FsyncPerBatch);
+            log.truncate();
+            log.setBuffered(true);
+            WriteQueue queue(locks);
+            queue.setFlush([&log]() { log.flushPending(); });
+            queue.start();
+            std::uint64_t records = writeRooms(threads, log, queue);
+            queue.stop();
+            batches = queue.getBatchCount();
+            return records;
+        });
+        results.push_back({"writes: WriteQueue" + suffix + ", " + std::to_string(batches) + " batches",
+                           queuedMs, 0, requests});
+    }
+    std::filesystem::remove(logPath);
+
+    // -------------------- Per-room writes: store lock vs room shards --------------------
+
+    // Each write changes one room and renders its record, as the service and
+    // check-in endpoints do. With one rooms lock every write waits for every
+    // other; with room shards, writes to rooms in different shards only share it.
+    std::shared_mutex shardedMutexes[StoreLocks::COUNT];
+    StoreLocks shardedLocks(shardedMutexes[0], shardedMutexes[1], shardedMutexes[2], shardedMutexes[3]);
+    shardedLocks.setRoomShards(16);
+    auto writePerRoom = [&](unsigned threads, const StoreLocks& storeLocks) -> std::uint64_t {
+        std::vector<std::thread> workers;
+        std::vector<std::uint64_t> bytes(threads, 0);
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                for (int r = 0; r < writesPerThread; ++r) {
+                    Room& room = rooms[static_cast<size_t>((r * 7 + static_cast<int>(t)) % listRooms)];
+                    auto guard = storeLocks.writeRoom(StoreLocks::Rooms, room.roomId.str());
+                    room.pricePerDay += 1.0;
+                    room.jsonCache.invalidate();
+                    bytes[t] += room.toJson().size();
+                }
+            });
+        }
+        for (auto& worker : workers) worker.join();
+        std::uint64_t total = 0;
+        for (std::uint64_t b : bytes) total += b;
+        return total;
+    };
+    for (unsigned threads : {1u, 4u, 8u}) {
+        const double requests = static_cast<double>(threads) * writesPerThread;
+        const std::string suffix = " x" + std::to_string(threads);
+        const double storeMs = time_ms([&]() -> std::uint64_t { return writePerRoom(threads, locks); });
+        results.push_back({"shards: per-room writes, store lock" + suffix, storeMs, 0, requests});
+        const double shardMs = time_ms([&]() -> std::uint64_t { return writePerRoom(threads, shardedLocks); });
+        results.push_back({"shards: per-room writes, 16 room shards" + suffix, shardMs, 0, requests});
+    }
+
     // -------------------- Backtracking: RoomCombinationSolver --------------------
 
     std::vector<Room> smallRooms;
@@ -288,7 +1153,6 @@ int main(int argc, char** argv) {
         r.roomType = roomTypes[static_cast<size_t>(i % static_cast<int>(roomTypes.size()))];
         r.pricePerDay = 500.0;
         r.isAvailable = true;
-        r.serviceList = nullptr;
         smallRooms.push_back(std::move(r));
     }
 
@@ -309,7 +1173,7 @@ int main(int argc, char** argv) {
     // -------------------- Results --------------------
     std::cout << "--- Results ---\n";
     for (const auto& r : results) {
-        print_row(r.name, r.ms);
+        print_row(r.name, r.ms, r.bytes, r.records, r.allocs);
     }
 
     std::cout << "\nTip: run with --repeats 20 for steadier numbers.\n";
@@ -0,0 +1,163 @@
+#include "BinarySnapshot.h"
+
+#include <filesystem>
+#include <fstream>
+
+static const char MAGIC[8] = {'H', 'T', 'L', 'S', 'N', 'A', 'P', '\0'};
+static const uint32_t ENDIAN_MARKER = 0x01020304u;
+
+// ==================== WRITER ====================
+
+BinarySnapshotWriter::BinarySnapshotWriter(std::ostream& out) : out(out), rows(0) {}
+
+void BinarySnapshotWriter::writeHeader(uint32_t tableCount) {
+    out.write(MAGIC, sizeof(MAGIC));
+    put(BinarySnapshotReader::VERSION);
+    put(ENDIAN_MARKER);
+    put(tableCount);
+}
+
+void BinarySnapshotWriter::putName(const std::string& name) {
+    put(static_cast<uint32_t>(name.size()));
+    out.write(name.data(), static_cast<std::streamsize>(name.size()));
+}
+
+void BinarySnapshotWriter::beginTable(const std::string& name, uint32_t rowCount, uint32_t columns) {
+    rows = rowCount;
+    putName(name);
+    put(rows);
+    put(columns);
+}
+
+void BinarySnapshotWriter::beginColumn(const std::string& name, uint8_t type) {
+    putName(name);
+    put(type);
+}
+
+bool BinarySnapshotWriter::good() const {
+    return static_cast<bool>(out);
+}
+
+// ==================== READER ====================
+
+namespace {
+
+struct Cursor {
+    const char* pos;
+    const char* end;
+
+    bool take(size_t n, const char*& out) {
+        if (static_cast<size_t>(end - pos) < n) return false;
+        out = pos;
+        pos += n;
+        return true;
+    }
+
+    template <class T>
+    bool read(T& value) {
+        const char* p;
+        if (!take(sizeof(T), p)) return false;
+        std::memcpy(&value, p, sizeof(T));
+        return true;
+    }
+
+    bool readName(std::string& name) {
+        uint32_t len;
+        const char* p;
+        if (!read(len) || !take(len, p)) return false;
+        name.assign(p, len);
+        return true;
+    }
+};
+
+size_t fixedWidth(uint8_t type) {
+    switch (type) {
+        case BinarySnapshotWriter::TYPE_INT32: return sizeof(int32_t);
+        case BinarySnapshotWriter::TYPE_FLOAT64: return sizeof(double);
+        case BinarySnapshotWriter::TYPE_BOOL: return sizeof(uint8_t);
+        default: return 0;
+    }
+}
+
+} // namespace
+
+bool BinarySnapshotReader::open(const std::string& path) {
+    buffer.clear();
+    tables.clear();
+
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) return false;
+    std::streamsize size = file.tellg();
+    if (size <= 0) return false;
+    buffer.resize(static_cast<size_t>(size));
+    file.seekg(0);
+    if (!file.read(buffer.data(), size)) return false;
+
+    Cursor cur{buffer.data(), buffer.data() + buffer.size()};
+    const char* magic;
+    uint32_t version, endian, tableCount;
+    if (!cur.take(sizeof(MAGIC), magic) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) return false;
+    if (!cur.read(version) || version != VERSION) return false;
+    if (!cur.read(endian) || endian != ENDIAN_MARKER) return false;
+    if (!cur.read(tableCount)) return false;
+
+    for (uint32_t t = 0; t < tableCount; ++t) {
+        Table table;
+        uint32_t columnCount;
+        if (!cur.readName(table.name) || !cur.read(table.rows) || !cur.read(columnCount)) return false;
+
+        for (uint32_t c = 0; c < columnCount; ++c) {
+            Column col;
+            if (!cur.readName(col.name) || !cur.read(col.type)) return false;
+
+            if (col.type == BinarySnapshotWriter::TYPE_STRING) {
+                const size_t offsetBytes = (static_cast<size_t>(table.rows) + 1) * sizeof(uint32_t);
+                if (!cur.take(offsetBytes, col.data)) return false;
+                const uint32_t total = get<uint32_t>(col.data, table.rows);
+                if (!cur.take(total, col.strings)) return false;
+            } else {
+                const size_t width = fixedWidth(col.type);
+                if (width == 0 || !cur.take(width * table.rows, col.data)) return false;
+            }
+            table.columns.push_back(col);
+        }
+        tables.push_back(std::move(table));
+    }
+    return true;
+}
+
+const BinarySnapshotReader::Table* BinarySnapshotReader::table(const std::string& name) const {
+    for (const Table& t : tables) {
+        if (t.name == name) return &t;
+    }
+    return nullptr;
+}
+
+const BinarySnapshotReader::Column* BinarySnapshotReader::Table::column(const std::string& name, uint8_t type) const {
+    for (const Column& c : columns) {
+        if (c.name == name && c.type == type) return &c;
+    }
+    return nullptr;
+}
+
+std::string binarySnapshotPath(const std::string& jsonPath) {
+    const std::string ext = ".json";
+    if (jsonPath.size() >= ext.size() &&
+        jsonPath.compare(jsonPath.size() - ext.size(), ext.size(), ext) == 0) {
+        return jsonPath.substr(0, jsonPath.size() - ext.size()) + ".bin";
+    }
+    return jsonPath + ".bin";
+}
+
+bool binarySnapshotIsCurrent(const std::string& jsonPath) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    const std::string binPath = binarySnapshotPath(jsonPath);
+    if (!fs::exists(binPath, ec)) return false;
+    if (!fs::exists(jsonPath, ec)) return true;
+    auto binTime = fs::last_write_time(binPath, ec);
+    if (ec) return false;
+    auto jsonTime = fs::last_write_time(jsonPath, ec);
+    if (ec) return true;
+    return binTime >= jsonTime;
+}
@@ -1,4 +1,6 @@
 #include "CustomerManagement.h"
+#include "JsonReader.h"
+#include "ParallelParse.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -6,143 +8,318 @@
 #include <vector>
 #include <algorithm>
 #include <chrono>
+#include <memory>
 using namespace std;
 
-CustomerManager::CustomerManager() : head(nullptr), count(0) {}
+CustomerManager::CustomerManager()
+    : oplog(CUSTOMER_FILE + ".log"), snapshotWriter(nullptr),
+      storageFormat(StorageFormat::Json), nameOrderVersion(0) {}
 
-CustomerManager::~CustomerManager() {
-    Customer* curr = head;
-    while (curr) {
-        Customer* temp = curr;
-        curr = curr->next;
-        delete temp;
+// Fills a customer from the reader's current object in a single pass.
+static bool readCustomer(JsonReader& reader, Customer& c) {
+    JsonField f;
+    while (reader.nextField(f)) {
+        if (f.key == "customerId") {
+            string id;
+            JsonReader::toString(f, id);
+            c.customerId = id;
+        }
+        else if (f.key == "fullName") JsonReader::toString(f, c.fullName);
+        else if (f.key == "idCard") JsonReader::toString(f, c.idCard);
+        else if (f.key == "phoneNumber") JsonReader::toString(f, c.phoneNumber);
     }
-    custIndex.clear();
+    return !reader.failed();
+}
+
+CustomerManager::~CustomerManager() {}
+
+static bool writeCustomers(ostream& file, const vector<const Customer*>& customers) {
+    return JsonWriter::writeFileArray(file, customers.size(), [&](size_t i, JsonWriter& w) {
+        customers[i]->writeJson(w);
+    });
+}
+
+static bool writeCustomersBinary(ostream& file, const vector<const Customer*>& customers) {
+    BinarySnapshotWriter out(file);
+    out.writeHeader(1);
+    out.beginTable("customers", static_cast<uint32_t>(customers.size()), 4);
+    out.stringColumn("customerId", [&](uint32_t i) -> const string& { return customers[i]->customerId.str(); });
+    out.stringColumn("fullName", [&](uint32_t i) -> const string& { return customers[i]->fullName; });
+    out.stringColumn("idCard", [&](uint32_t i) -> const string& { return customers[i]->idCard; });
+    out.stringColumn("phoneNumber", [&](uint32_t i) -> const string& { return customers[i]->phoneNumber; });
+    return out.good();
 }
 
 void CustomerManager::saveToFile() {
-    ofstream file(CUSTOMER_FILE);
-    if (!file.is_open()) {
+    if (snapshotWriter) snapshotWriter->waitFor(oplog);
+
+    ++version;
+    vector<const Customer*> list;
+    list.reserve(customers.size());
+    customers.forEach([&list](Customer& c) {
+        c.jsonCache.invalidate();
+        list.push_back(&c);
+    });
+
+    const bool binary = storageFormat == StorageFormat::Binary;
+    bool ok = SnapshotWriter::writeAtomically(checkpointPath(), [&list, binary](ostream& file) {
+        return binary ? writeCustomersBinary(file, list) : writeCustomers(file, list);
+    }, oplog.getDurability());
+    if (!ok) {
         cout << "Loi: Khong the luu du lieu khach hang!\n";
         return;
     }
-    
-    file << "[\n";
-    Customer* curr = head;
-    bool first = true;
-    while (curr) {
-        if (!first) file << ",\n";
-        file << curr->toJson();
-        first = false;
-        curr = curr->next;
+    oplog.truncate();
+}
+
+string CustomerManager::checkpointPath() const {
+    return storageFormat == StorageFormat::Binary ? binarySnapshotPath(CUSTOMER_FILE) : CUSTOMER_FILE;
+}
+
+void CustomerManager::setStorageFormat(StorageFormat format) {
+    storageFormat = format;
+}
+
+bool CustomerManager::exportToJson() {
+    vector<const Customer*> list;
+    list.reserve(customers.size());
+    customers.forEach([&list](const Customer& c) { list.push_back(&c); });
+    return SnapshotWriter::writeAtomically(CUSTOMER_FILE, [&list](ostream& file) {
+        return writeCustomers(file, list);
+    });
+}
+
+bool CustomerManager::loadFromBinary(const string& path) {
+    using Reader = BinarySnapshotReader;
+    Reader reader;
+    if (!reader.open(path)) return false;
+    const Reader::Table* t = reader.table("customers");
+    if (!t) return false;
+    const Reader::Column* id = t->column("customerId", BinarySnapshotWriter::TYPE_STRING);
+    const Reader::Column* name = t->column("fullName", BinarySnapshotWriter::TYPE_STRING);
+    const Reader::Column* card = t->column("idCard", BinarySnapshotWriter::TYPE_STRING);
+    const Reader::Column* phone = t->column("phoneNumber", BinarySnapshotWriter::TYPE_STRING);
+    if (!id || !name || !card || !phone) return false;
+
+    customers.reserve(t->rows);
+    for (uint32_t row = 0; row < t->rows; ++row) {
+        insertCustomer(Customer(Reader::stringAt(*id, row), Reader::stringAt(*name, row),
+                                Reader::stringAt(*card, row), Reader::stringAt(*phone, row)));
     }
-    file << "\n]\n";
-    
-    file.close();
+    return true;
+}
+
+bool CustomerManager::checkpointInBackground() {
+    if (!snapshotWriter) return false;
+
+    auto image = make_shared<vector<Customer>>();
+    image->reserve(customers.size());
+    customers.forEach([&image](const Customer& c) { image->push_back(c); });
+
+    const bool binary = storageFormat == StorageFormat::Binary;
+    return snapshotWriter->scheduleCheckpoint(oplog, checkpointPath(), [image, binary](ostream& file) {
+        vector<const Customer*> list;
+        list.reserve(image->size());
+        for (const Customer& c : *image) list.push_back(&c);
+        return binary ? writeCustomersBinary(file, list) : writeCustomers(file, list);
+    });
+}
+
+void CustomerManager::setSnapshotWriter(SnapshotWriter* writer) {
+    snapshotWriter = writer;
+}
+
+void CustomerManager::maybeCheckpoint() {
+    if (oplog.getRecordCount() < OperationLog::CHECKPOINT_INTERVAL) return;
+    if (snapshotWriter) checkpointInBackground();
+    else saveToFile();
+}
+
+void CustomerManager::logPut(Customer& customer) {
+    customer.jsonCache.invalidate();
+    customer.revision = ++version;
+    oplog.appendPut(customer.customerId.str(), customer.toJson());
+    maybeCheckpoint();
+}
+
+void CustomerManager::logDelete(const string& id) {
+    ++version;
+    oplog.appendDelete(id);
+    maybeCheckpoint();
+}
+
+void CustomerManager::applyLogRecord(OperationLog::Op op, const string& payload) {
+    if (op == OperationLog::Op::Delete) {
+        removeCustomer(payload);
+        return;
+    }
+
+    Customer parsed;
+    JsonReader reader(payload);
+    if (!reader.nextObject() || !readCustomer(reader, parsed)) {
+        cerr << "Skipping invalid customer log record\n";
+        return;
+    }
+    if (parsed.customerId.empty()) return;
+    parsed.revision = ++version;
+
+    if (Customer* existing = findCustomer(parsed.customerId)) {
+        existing->fullName = parsed.fullName;
+        existing->idCard = parsed.idCard;
+        existing->phoneNumber = parsed.phoneNumber;
+        existing->revision = parsed.revision;
+        return;
+    }
+    insertCustomer(std::move(parsed));
+}
+
+Customer* CustomerManager::insertCustomer(Customer customer) {
+    const CustomerKey key = customer.customerId;
+    const SlabStore<Customer>::Handle h = customers.insert(std::move(customer));
+    setHandle(key, h);
+    return &customers[h];
+}
+
+bool CustomerManager::removeCustomer(const string& id) {
+    CustomerKey key;
+    if (!CustomerKey::find(id, key)) return false;
+    const SlabStore<Customer>::Handle h = handleOf(key);
+    if (h == NO_HANDLE) return false;
+    customers.erase(h);
+    setHandle(key, NO_HANDLE);
+    return true;
+}
+
+SlabStore<Customer>::Handle CustomerManager::handleOf(CustomerKey key) const {
+    return key.index() < handleByKey.size() ? handleByKey[key.index()] : NO_HANDLE;
+}
+
+void CustomerManager::setHandle(CustomerKey key, SlabStore<Customer>::Handle h) {
+    if (key.index() >= handleByKey.size()) {
+        if (h == NO_HANDLE) return;
+        handleByKey.resize(CustomerIds::dictionary().size(), NO_HANDLE);
+    }
+    handleByKey[key.index()] = h;
 }
 
 bool CustomerManager::addCustomer(string id, string name, string idCard, string phone) {
-    if (custIndex.find(id) != custIndex.end()) {
+    if (findCustomer(id)) {
         cout << "Loi: Ma khach da ton tai!\n";
         return false;
     }
     
-    Customer* newCustomer = new Customer(id, name, idCard, phone);
-    newCustomer->next = head;
-    head = newCustomer;
-    count++;
-    custIndex[id] = newCustomer;
+    Customer* newCustomer = insertCustomer(Customer(id, name, idCard, phone));
     
     cout << "Them khach hang thanh cong!\n";
-    saveToFile();
+    logPut(*newCustomer);
     return true;
 }
 
 bool CustomerManager::deleteCustomer(string id) {
-    if (!head) {
+    if (customers.empty()) {
         cout << "Loi: Danh sach khach hang rong!\n";
         return false;
     }
     
-    if (head->customerId == id) {
-        Customer* temp = head;
-        head = head->next;
-        delete temp;
-        count--;
-        custIndex.erase(id);
+    if (removeCustomer(id)) {
         cout << "Xoa khach hang thanh cong!\n";
-        saveToFile();
+        logDelete(id);
         return true;
     }
     
-    Customer* curr = head;
-    while (curr->next) {
-        if (curr->next->customerId == id) {
-            Customer* temp = curr->next;
-            curr->next = curr->next->next;
-            delete temp;
-            count--;
-            custIndex.erase(id);
-            cout << "Xoa khach hang thanh cong!\n";
-            saveToFile();
-            return true;
-        }
-        curr = curr->next;
-    }
-    
     cout << "Loi: Khong tim thay khach hang!\n";
     return false;
 }
 
 Customer* CustomerManager::findCustomer(string id) {
-    auto it = custIndex.find(id);
-    if (it == custIndex.end()) return nullptr;
-    return it->second;
+    CustomerKey key;
+    if (!CustomerKey::find(id, key)) return nullptr;
+    return findCustomer(key);
+}
+
+Customer* CustomerManager::findCustomer(CustomerKey key) {
+    const SlabStore<Customer>::Handle h = handleOf(key);
+    return h == NO_HANDLE ? nullptr : &customers[h];
 }
 int CustomerManager::getCustomerCount() { 
-    return count; 
-}
-
-Customer* CustomerManager::getHead() {
-    return head;
-}
-
-void CustomerManager::loadFromJson(const string& json) {
-    size_t pos = 1;
-    while (pos < json.length()) {
-        size_t start = json.find("{", pos);
-        if (start == string::npos) break;
-        
-        size_t end = json.find("}", start);
-        if (end == string::npos) break;
-        
-        string obj = json.substr(start, end - start + 1);
-        
-        string id = JsonHelper::extractValue(obj, "customerId");
-        string name = JsonHelper::extractValue(obj, "fullName");
-        string card = JsonHelper::extractValue(obj, "idCard");
-        string phone = JsonHelper::extractValue(obj, "phoneNumber");
-        
-        Customer* newCust = new Customer(id, name, card, phone);
-        newCust->next = head;
-        head = newCust;
-        count++;
-        custIndex[id] = newCust;
-        
-        pos = end + 1;
+    return static_cast<int>(customers.size()); 
+}
+
+OperationLog& CustomerManager::getOperationLog() {
+    return oplog;
+}
+
+std::shared_mutex& CustomerManager::getMutex() const {
+    return storeMutex;
+}
+
+uint64_t CustomerManager::getVersion() const {
+    return version.load();
+}
+
+std::shared_ptr<const vector<SlabStore<Customer>::Handle>> CustomerManager::sortedByName() {
+    std::lock_guard<std::mutex> lock(nameOrderMtx);
+    const uint64_t current = version.load();
+    if (nameOrder && nameOrderVersion == current) return nameOrder;
+
+    auto order = std::make_shared<vector<SlabStore<Customer>::Handle>>();
+    order->reserve(customers.size());
+    for (SlabStore<Customer>::Handle h : handleByKey) {
+        if (h != NO_HANDLE) order->push_back(h);
     }
+    std::sort(order->begin(), order->end(),
+              [this](SlabStore<Customer>::Handle a, SlabStore<Customer>::Handle b) {
+                  return customers[a].fullName < customers[b].fullName;
+              });
+    nameOrder = std::move(order);
+    nameOrderVersion = current;
+    return nameOrder;
 }
 
-void CustomerManager::loadFromFile() {
-    ifstream file(CUSTOMER_FILE);
-    if (!file.is_open()) {
-        return;
+// Parses one chunk of customers.json; malformed records are skipped.
+static void parseCustomerChunk(std::string_view chunk, vector<Customer>& out) {
+    JsonReader reader(chunk);
+    while (reader.nextObject()) {
+        Customer c;
+        if (!readCustomer(reader, c)) {
+            cerr << "Skipping invalid customer record\n";
+            break;
+        }
+        out.push_back(std::move(c));
     }
-    
-    stringstream buffer;
-    buffer << file.rdbuf();
-    string json = buffer.str();
-    file.close();
-    
-    loadFromJson(json);
+}
+
+void CustomerManager::loadFromJson(const string& json, ThreadPool* pool) {
+    vector<vector<Customer>> parts = parseJsonArrayChunks<Customer>(json, pool, parseCustomerChunk);
+
+    size_t total = 0;
+    for (const auto& part : parts) total += part.size();
+    customers.reserve(total);
+
+    for (auto& part : parts) {
+        for (Customer& c : part) insertCustomer(std::move(c));
+    }
+}
+
+void CustomerManager::loadFromFile(ThreadPool* pool) {
+    ifstream file;
+    if (!binarySnapshotIsCurrent(CUSTOMER_FILE) || !loadFromBinary(binarySnapshotPath(CUSTOMER_FILE))) {
+        file.open(CUSTOMER_FILE);
+    }
+    const bool importedJson = file.is_open();
+    if (importedJson) {
+        stringstream buffer;
+        buffer << file.rdbuf();
+        string json = buffer.str();
+        file.close();
+
+        loadFromJson(json, pool);
+    }
+
+    oplog.replay([this](OperationLog::Op op, const string& payload) {
+        applyLogRecord(op, payload);
+    });
+
+    // First start in binary mode: convert the imported JSON right away.
+    if (importedJson && storageFormat == StorageFormat::Binary) saveToFile();
 }
\ No newline at end of file
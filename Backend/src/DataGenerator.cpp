@@ -5,19 +5,13 @@
 #include <iomanip>
 #include <map>
 
-// Helper: Convert date to days since epoch for easy comparison
-static long long dateToDays(int day, int month, int year) {
-    // Simple conversion: year*365 + month*30 + day
-    return year * 365LL + month * 30LL + day;
-}
-
 // Check if two date ranges overlap
 bool DataGenerator::datesOverlap(int d1, int m1, int y1, int d2, int m2, int y2,
                                  int d3, int m3, int y3, int d4, int m4, int y4) {
-    long long start1 = dateToDays(d1, m1, y1);
-    long long end1 = dateToDays(d2, m2, y2);
-    long long start2 = dateToDays(d3, m3, y3);
-    long long end2 = dateToDays(d4, m4, y4);
+    DayNumber start1 = daysFromCivil(y1, m1, d1);
+    DayNumber end1 = daysFromCivil(y2, m2, d2);
+    DayNumber start2 = daysFromCivil(y3, m3, d3);
+    DayNumber end2 = daysFromCivil(y4, m4, d4);
     
     // Two ranges overlap if: start1 < end2 AND start2 < end1
     return start1 < end2 && start2 < end1;
@@ -125,7 +119,9 @@ void DataGenerator::generateReservations(ReservationManager& resMgr,
     int custCount = custMgr.getCustomerCount();
     if (roomCount == 0 || custCount == 0) return;
 
-    Room* rooms = roomMgr.getRooms();
+    vector<Room*> rooms;
+    rooms.reserve(roomCount);
+    roomMgr.forEachRoom([&rooms](Room& room) { rooms.push_back(&room); });
     vector<string> statuses = {"pending", "checkedIn", "checkedOut"};
     
     // Track existing reservations for overlap checking
@@ -149,7 +145,7 @@ void DataGenerator::generateReservations(ReservationManager& resMgr,
 
         // Choose room with rotation (spread across rooms)
         int roomIndex = (created * 7) % roomCount;
-        string roomId = rooms[roomIndex].roomId;
+        string roomId = rooms[roomIndex]->roomId.str();
 
         // Generate dates (2025-2026 only per spec)
         int inY = randomInt(2025, 2026);
@@ -207,29 +203,29 @@ void DataGenerator::generateReservations(ReservationManager& resMgr,
                 return leq(y1, m1, d1, TY, TM, TD) && geq(y2, m2, d2, TY, TM, TD);
             };
 
-            string status;
+            ReservationStatus status;
             int rand_val = rand() % 100;
             if (before_today(outY, outM, outD)) {
                 // Past -> checkedOut or cancel
-                status = (rand_val < 20) ? "cancel" : "checkedOut";
+                status = (rand_val < 20) ? ReservationStatus::Cancelled : ReservationStatus::CheckedOut;
             } else if (after_today(inY, inM, inD)) {
                 // Future -> pending
-                status = "pending";
+                status = ReservationStatus::Pending;
             } else if (includes_today(inY, inM, inD, outY, outM, outD)) {
                 // Spans today -> checkedIn, pending, or cancel
                 if (rand_val < 50) {
-                    status = "checkedIn";
+                    status = ReservationStatus::CheckedIn;
                 } else if (rand_val < 85) {
-                    status = "pending";
+                    status = ReservationStatus::Pending;
                 } else {
-                    status = "cancel";
+                    status = ReservationStatus::Cancelled;
                 }
             } else {
-                status = "pending";
+                status = ReservationStatus::Pending;
             }
 
-            resMgr.makeReservation(resId, custId, roomId, inD, inM, inY, outD, outM, outY, 
-                                  custMgr, roomMgr, status);
+            resMgr.makeReservation(resId, custId, roomId, daysFromCivil(inY, inM, inD),
+                                  daysFromCivil(outY, outM, outD), custMgr, roomMgr, status);
             roomReservations[roomId].push_back(make_tuple(inD, inM, inY, outD, outM, outY));
             created++;
         }
@@ -285,35 +281,20 @@ void DataGenerator::generateAllData(RoomManager& roomMgr,
     
     // Update room availability based on reservations (only unavailable if checkedIn spans today)
     cout << "Updating room availability based on reservations...\n";
-    const int TY = 2025, TM = 12, TD = 25;
-    auto includes_today = [](int y1, int m1, int d1, int y2, int m2, int d2) {
-        const int TY = 2025, TM = 12, TD = 25;
-        auto leq = [](int a, int b, int c, int x, int y, int z) {
-            if (a != x) return a < x; if (b != y) return b < y; return c <= z;
-        };
-        auto geq = [](int a, int b, int c, int x, int y, int z) {
-            if (a != x) return a > x; if (b != y) return b > y; return c >= z;
-        };
-        return leq(y1, m1, d1, TY, TM, TD) && geq(y2, m2, d2, TY, TM, TD);
-    };
+    const DayNumber today = daysFromCivil(2025, 12, 25);
     
     // First set all rooms to available
-    Room* rooms = roomMgr.getRooms();
-    int totalRooms = roomMgr.getRoomCount();
-    for (int i = 0; i < totalRooms; i++) {
-        roomMgr.updateRoomStatus(rooms[i].roomId, true);
-    }
+    roomMgr.forEachRoom([&roomMgr](Room& room) {
+        roomMgr.updateRoomStatus(room.roomId.str(), true);
+    });
     
     // Then mark unavailable if has checkedIn reservation spanning today
-    Reservation* reservations = resMgr.getReservations();
-    int resCount = resMgr.getReservationCount();
-    for (int i = 0; i < resCount; i++) {
-        if (string(reservations[i].status) == "checkedIn" &&
-            includes_today(reservations[i].checkInYear, reservations[i].checkInMonth, reservations[i].checkInDay,
-                          reservations[i].checkOutYear, reservations[i].checkOutMonth, reservations[i].checkOutDay)) {
-            roomMgr.updateRoomStatus(reservations[i].roomId, false);
+    resMgr.forEachReservation([&](const Reservation& r) {
+        if (r.status == ReservationStatus::CheckedIn &&
+            r.checkIn <= today && r.checkOut >= today) {
+            roomMgr.updateRoomStatus(r.roomId.str(), false);
         }
-    }
+    });
     
     generateInvoices(invMgr, roomMgr, resMgr, custMgr, autoInvoiceCount);
 }
@@ -0,0 +1,141 @@
+#include "DurableFile.h"
+
+#include <cerrno>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+const char* durabilityName(Durability level) {
+    switch (level) {
+        case Durability::None: return "none";
+        case Durability::FsyncPerBatch: return "batch";
+        case Durability::FsyncPerOp: return "op";
+        case Durability::DSync: return "dsync";
+    }
+    return "none";
+}
+
+DurableFile::DurableFile() : fd(-1), dsync(false) {}
+
+DurableFile::~DurableFile() {
+    close();
+}
+
+bool DurableFile::isOpen() const {
+    return fd >= 0;
+}
+
+#ifdef _WIN32
+
+bool DurableFile::openAppend(const std::string& path, bool dsyncWrites) {
+    close();
+    fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+    dsync = dsyncWrites;
+    return fd >= 0;
+}
+
+void DurableFile::close() {
+    if (fd >= 0) _close(fd);
+    fd = -1;
+}
+
+bool DurableFile::write(const char* data, size_t len) {
+    if (fd < 0) return false;
+    while (len > 0) {
+        const unsigned chunk = static_cast<unsigned>(len > (1u << 30) ? (1u << 30) : len);
+        const int n = _write(fd, data, chunk);
+        if (n <= 0) return false;
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return !dsync || sync();
+}
+
+bool DurableFile::sync() {
+    return fd >= 0 && _commit(fd) == 0;
+}
+
+bool DurableFile::syncPath(const std::string& path) {
+    const int f = _open(path.c_str(), _O_RDWR | _O_BINARY);
+    if (f < 0) return false;
+    const bool ok = _commit(f) == 0;
+    _close(f);
+    return ok;
+}
+
+bool DurableFile::syncParentDirectory(const std::string&) {
+    // NTFS journals the rename; directories cannot be opened for commit here.
+    return true;
+}
+
+#else
+
+bool DurableFile::openAppend(const std::string& path, bool dsyncWrites) {
+    close();
+    int flags = O_WRONLY | O_CREAT | O_APPEND;
+#ifdef O_CLOEXEC
+    flags |= O_CLOEXEC;
+#endif
+    if (dsyncWrites) flags |= O_DSYNC;
+    fd = ::open(path.c_str(), flags, 0644);
+    dsync = dsyncWrites;
+    return fd >= 0;
+}
+
+void DurableFile::close() {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+}
+
+bool DurableFile::write(const char* data, size_t len) {
+    if (fd < 0) return false;
+    while (len > 0) {
+        const ssize_t n = ::write(fd, data, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+static bool syncFd(int f) {
+#if defined(__APPLE__)
+    return ::fsync(f) == 0;
+#else
+    return ::fdatasync(f) == 0;
+#endif
+}
+
+bool DurableFile::sync() {
+    return fd >= 0 && syncFd(fd);
+}
+
+bool DurableFile::syncPath(const std::string& path) {
+    const int f = ::open(path.c_str(), O_RDONLY);
+    if (f < 0) return false;
+    const bool ok = ::fsync(f) == 0;
+    ::close(f);
+    return ok;
+}
+
+bool DurableFile::syncParentDirectory(const std::string& path) {
+    std::filesystem::path dir = std::filesystem::path(path).parent_path();
+    if (dir.empty()) dir = ".";
+    const int f = ::open(dir.c_str(), O_RDONLY);
+    if (f < 0) return false;
+    const bool ok = ::fsync(f) == 0;
+    ::close(f);
+    return ok;
+}
+
+#endif
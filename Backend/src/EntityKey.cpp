@@ -0,0 +1,13 @@
+#include "EntityKey.h"
+
+// Leaked like SymbolTable::global(): records destroyed during static teardown
+// may still read their ids.
+SymbolTable& RoomIds::dictionary() {
+    static SymbolTable* table = new SymbolTable(false);
+    return *table;
+}
+
+SymbolTable& CustomerIds::dictionary() {
+    static SymbolTable* table = new SymbolTable(false);
+    return *table;
+}
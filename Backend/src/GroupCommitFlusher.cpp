@@ -0,0 +1,108 @@
+#include "GroupCommitFlusher.h"
+#include "ThreadPool.h"
+
+#include <future>
+
+GroupCommitFlusher::GroupCommitFlusher(int windowMs)
+    : ioPool(nullptr), window(windowMs > 0 ? windowMs : 0),
+      startedBatches(0), completedBatches(0), dirty(false), running(false) {}
+
+GroupCommitFlusher::~GroupCommitFlusher() {
+    stop();
+}
+
+void GroupCommitFlusher::attach(OperationLog& log) {
+    log.setBuffered(true, [this]() { notifyDirty(); });
+    logs.push_back(&log);
+}
+
+void GroupCommitFlusher::setIoPool(ThreadPool* pool) {
+    ioPool = pool;
+}
+
+void GroupCommitFlusher::start() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (running) return;
+    running = true;
+    worker = std::thread(&GroupCommitFlusher::run, this);
+}
+
+void GroupCommitFlusher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!running) return;
+        running = false;
+    }
+    wakeCv.notify_all();
+    if (worker.joinable()) worker.join();
+    flushAll();
+    for (OperationLog* log : logs) log->setBuffered(false);
+}
+
+int GroupCommitFlusher::getWindowMs() const {
+    return static_cast<int>(window.count());
+}
+
+void GroupCommitFlusher::notifyDirty() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (dirty) return;
+        dirty = true;
+    }
+    wakeCv.notify_one();
+}
+
+void GroupCommitFlusher::waitDurable() {
+    std::unique_lock<std::mutex> lock(mtx);
+    if (!running) {
+        lock.unlock();
+        flushAll();
+        return;
+    }
+    // The batch that starts next swaps buffers after our records were appended.
+    const std::uint64_t target = startedBatches + 1;
+    dirty = true;
+    wakeCv.notify_one();
+    durableCv.wait(lock, [&]() { return completedBatches >= target || !running; });
+    if (completedBatches < target) {
+        lock.unlock();
+        flushAll();
+    }
+}
+
+void GroupCommitFlusher::flushAll() {
+    if (ioPool == nullptr || logs.size() < 2) {
+        for (OperationLog* log : logs) log->flushPending();
+        return;
+    }
+    std::vector<std::future<bool>> pending;
+    pending.reserve(logs.size());
+    for (OperationLog* log : logs) {
+        pending.push_back(ioPool->submit([log]() { return log->flushPending(); }));
+    }
+    for (auto& f : pending) f.get();
+}
+
+void GroupCommitFlusher::run() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        wakeCv.wait(lock, [&]() { return dirty || !running; });
+        if (!running) break;
+
+        // Let concurrent writers pile into this batch.
+        if (window.count() > 0) {
+            lock.unlock();
+            std::this_thread::sleep_for(window);
+            lock.lock();
+        }
+
+        dirty = false;
+        const std::uint64_t batch = ++startedBatches;
+        lock.unlock();
+        flushAll();
+        lock.lock();
+        completedBatches = batch;
+        durableCv.notify_all();
+    }
+    durableCv.notify_all();
+}
@@ -1,17 +1,57 @@
 #include "InvoiceManagement.h"
+#include "JsonReader.h"
+#include "ParallelParse.h"
 #include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
 #include <chrono>
+#include <memory>
+#include <vector>
 #include "ServiceManagement.h"
 using namespace std;
 
-InvoiceManager::InvoiceManager(int cap) : capacity(cap), count(0) {
+InvoiceManager::InvoiceManager(int cap)
+    : capacity(cap), count(0), oplog(INVOICE_FILE + ".log"), snapshotWriter(nullptr),
+      storageFormat(StorageFormat::Json) {
     invoices = new Invoice[capacity];
 }
 
+// Ids are stored as keys; the JSON string goes through a temporary.
+template <class Key>
+static void readKey(const JsonField& f, Key& key) {
+    string id;
+    JsonReader::toString(f, id);
+    key = id;
+}
+
+// Fills an invoice from the reader's current object in a single pass.
+// Returns false if a numeric field is malformed or a date is not a calendar date.
+static bool readInvoice(JsonReader& reader, Invoice& inv) {
+    bool ok = true;
+    int inD = 0, inM = 0, inY = 0, outD = 0, outM = 0, outY = 0;
+    JsonField f;
+    while (reader.nextField(f)) {
+        if (f.key == "invoiceId") JsonReader::toString(f, inv.invoiceId);
+        else if (f.key == "customerId") readKey(f, inv.customerId);
+        else if (f.key == "roomId") readKey(f, inv.roomId);
+        else if (f.key == "checkInDay") ok &= JsonReader::toInt(f, inD);
+        else if (f.key == "checkInMonth") ok &= JsonReader::toInt(f, inM);
+        else if (f.key == "checkInYear") ok &= JsonReader::toInt(f, inY);
+        else if (f.key == "checkOutDay") ok &= JsonReader::toInt(f, outD);
+        else if (f.key == "checkOutMonth") ok &= JsonReader::toInt(f, outM);
+        else if (f.key == "checkOutYear") ok &= JsonReader::toInt(f, outY);
+        else if (f.key == "roomCharge") ok &= JsonReader::toDouble(f, inv.roomCharge);
+        else if (f.key == "serviceCharge") ok &= JsonReader::toDouble(f, inv.serviceCharge);
+        else if (f.key == "totalAmount") ok &= JsonReader::toDouble(f, inv.totalAmount);
+    }
+    ok &= isValidCivil(inY, inM, inD) && isValidCivil(outY, outM, outD);
+    inv.checkIn = daysFromCivil(inY, inM, inD);
+    inv.checkOut = daysFromCivil(outY, outM, outD);
+    return ok && !reader.failed();
+}
+
 InvoiceManager::~InvoiceManager() {
     delete[] invoices;
 }
@@ -30,48 +70,230 @@ void InvoiceManager::resize() {
 void InvoiceManager::rebuildIndex() {
     invoiceIndex.clear();
     for (int i = 0; i < count; ++i) {
-        invoiceIndex[invoices[i].invoiceId] = i;
+        if (!deleted.isDead(i)) invoiceIndex[invoices[i].invoiceId] = i;
+    }
+}
+
+// O(1): the slot becomes a tombstone and only this id leaves the index.
+void InvoiceManager::removeAt(int slot) {
+    invoiceIndex.erase(invoices[slot].invoiceId);
+    invoices[slot] = Invoice();
+    deleted.mark(slot);
+}
+
+// Runs only from delete paths, which hold the store exclusively: moving
+// invoices would invalidate pointers a shared-lock caller still holds.
+void InvoiceManager::compactIfDue() {
+    if (!deleted.compactionDue(count)) return;
+    count = deleted.compact(invoices, count);
+    rebuildIndex();
+}
+
+vector<const Invoice*> InvoiceManager::liveInvoices() const {
+    vector<const Invoice*> list;
+    list.reserve(count - deleted.count());
+    for (int i = 0; i < count; ++i) {
+        if (!deleted.isDead(i)) list.push_back(&invoices[i]);
     }
+    return list;
 }
 
 bool InvoiceManager::existsForReservation(const Reservation& r) {
     for (int i = 0; i < count; ++i) {
+        if (deleted.isDead(i)) continue;
         const Invoice& inv = invoices[i];
         if (inv.customerId == r.customerId &&
             inv.roomId == r.roomId &&
-            inv.checkInDay == r.checkInDay &&
-            inv.checkInMonth == r.checkInMonth &&
-            inv.checkInYear == r.checkInYear &&
-            inv.checkOutDay == r.checkOutDay &&
-            inv.checkOutMonth == r.checkOutMonth &&
-            inv.checkOutYear == r.checkOutYear) {
+            inv.checkIn == r.checkIn &&
+            inv.checkOut == r.checkOut) {
             return true;
         }
     }
     return false;
 }
 
-int InvoiceManager::calculateDays(int d1, int m1, int y1, int d2, int m2, int y2) {
-    int days = (y2 - y1) * 365 + (m2 - m1) * 30 + (d2 - d1);
+int InvoiceManager::calculateDays(DayNumber checkIn, DayNumber checkOut) {
+    int days = checkOut - checkIn;
     return days > 0 ? days : 1;
 }
 
+static bool writeInvoices(ostream& file, const vector<const Invoice*>& invoices) {
+    return JsonWriter::writeFileArray(file, invoices.size(), [&](size_t i, JsonWriter& w) {
+        invoices[i]->writeJson(w);
+    });
+}
+
+static bool writeInvoicesBinary(ostream& file, const vector<const Invoice*>& invoices) {
+    BinarySnapshotWriter out(file);
+    out.writeHeader(1);
+    out.beginTable("invoices", static_cast<uint32_t>(invoices.size()), 12);
+    out.stringColumn("invoiceId", [&](uint32_t i) -> const string& { return invoices[i]->invoiceId; });
+    out.stringColumn("customerId", [&](uint32_t i) -> const string& { return invoices[i]->customerId.str(); });
+    out.stringColumn("roomId", [&](uint32_t i) -> const string& { return invoices[i]->roomId.str(); });
+    out.int32Column("checkInDay", [&](uint32_t i) { return civilFromDays(invoices[i]->checkIn).day; });
+    out.int32Column("checkInMonth", [&](uint32_t i) { return civilFromDays(invoices[i]->checkIn).month; });
+    out.int32Column("checkInYear", [&](uint32_t i) { return civilFromDays(invoices[i]->checkIn).year; });
+    out.int32Column("checkOutDay", [&](uint32_t i) { return civilFromDays(invoices[i]->checkOut).day; });
+    out.int32Column("checkOutMonth", [&](uint32_t i) { return civilFromDays(invoices[i]->checkOut).month; });
+    out.int32Column("checkOutYear", [&](uint32_t i) { return civilFromDays(invoices[i]->checkOut).year; });
+    out.float64Column("roomCharge", [&](uint32_t i) { return invoices[i]->roomCharge; });
+    out.float64Column("serviceCharge", [&](uint32_t i) { return invoices[i]->serviceCharge; });
+    out.float64Column("totalAmount", [&](uint32_t i) { return invoices[i]->totalAmount; });
+    return out.good();
+}
+
 void InvoiceManager::saveToFile() {
-    ofstream file(INVOICE_FILE);
-    if (!file.is_open()) {
+    if (snapshotWriter) snapshotWriter->waitFor(oplog);
+    // Whole-store edits (rebuildFromReservationsStrict) checkpoint instead of logging records.
+    for (int i = 0; i < count; i++) invoices[i].jsonCache.invalidate();
+    ++version;
+
+    const vector<const Invoice*> list = liveInvoices();
+    const bool binary = storageFormat == StorageFormat::Binary;
+    bool ok = SnapshotWriter::writeAtomically(checkpointPath(), [&list, binary](ostream& file) {
+        return binary ? writeInvoicesBinary(file, list) : writeInvoices(file, list);
+    }, oplog.getDurability());
+    if (!ok) {
         cout << "Loi: Khong the luu du lieu hoa don!\n";
         return;
     }
-    
-    file << "[\n";
-    for (int i = 0; i < count; i++) {
-        file << invoices[i].toJson();
-        if (i < count - 1) file << ",\n";
-        else file << "\n";
+    oplog.truncate();
+}
+
+string InvoiceManager::checkpointPath() const {
+    return storageFormat == StorageFormat::Binary ? binarySnapshotPath(INVOICE_FILE) : INVOICE_FILE;
+}
+
+void InvoiceManager::setStorageFormat(StorageFormat format) {
+    storageFormat = format;
+}
+
+bool InvoiceManager::exportToJson() {
+    const vector<const Invoice*> list = liveInvoices();
+    return SnapshotWriter::writeAtomically(INVOICE_FILE, [&list](ostream& file) {
+        return writeInvoices(file, list);
+    });
+}
+
+bool InvoiceManager::loadFromBinary(const string& path) {
+    using Reader = BinarySnapshotReader;
+    Reader reader;
+    if (!reader.open(path)) return false;
+    const Reader::Table* t = reader.table("invoices");
+    if (!t) return false;
+    const Reader::Column* invoiceIdCol = t->column("invoiceId", BinarySnapshotWriter::TYPE_STRING);
+    const Reader::Column* customerIdCol = t->column("customerId", BinarySnapshotWriter::TYPE_STRING);
+    const Reader::Column* roomIdCol = t->column("roomId", BinarySnapshotWriter::TYPE_STRING);
+    const Reader::Column* checkInDayCol = t->column("checkInDay", BinarySnapshotWriter::TYPE_INT32);
+    const Reader::Column* checkInMonthCol = t->column("checkInMonth", BinarySnapshotWriter::TYPE_INT32);
+    const Reader::Column* checkInYearCol = t->column("checkInYear", BinarySnapshotWriter::TYPE_INT32);
+    const Reader::Column* checkOutDayCol = t->column("checkOutDay", BinarySnapshotWriter::TYPE_INT32);
+    const Reader::Column* checkOutMonthCol = t->column("checkOutMonth", BinarySnapshotWriter::TYPE_INT32);
+    const Reader::Column* checkOutYearCol = t->column("checkOutYear", BinarySnapshotWriter::TYPE_INT32);
+    const Reader::Column* roomChargeCol = t->column("roomCharge", BinarySnapshotWriter::TYPE_FLOAT64);
+    const Reader::Column* serviceChargeCol = t->column("serviceCharge", BinarySnapshotWriter::TYPE_FLOAT64);
+    const Reader::Column* totalAmountCol = t->column("totalAmount", BinarySnapshotWriter::TYPE_FLOAT64);
+    if (!invoiceIdCol || !customerIdCol || !roomIdCol || !checkInDayCol ||
+        !checkInMonthCol || !checkInYearCol || !checkOutDayCol || !checkOutMonthCol ||
+        !checkOutYearCol || !roomChargeCol || !serviceChargeCol || !totalAmountCol) {
+        return false;
     }
-    file << "]\n";
-    
-    file.close();
+
+    while (capacity < count + static_cast<int>(t->rows)) resize();
+    invoiceIndex.reserve(count + t->rows);
+    for (uint32_t row = 0; row < t->rows; row++) {
+        Invoice& rec = invoices[count];
+        rec.invoiceId = Reader::stringAt(*invoiceIdCol, row);
+        rec.customerId = Reader::stringAt(*customerIdCol, row);
+        rec.roomId = Reader::stringAt(*roomIdCol, row);
+        const int inY = Reader::int32At(*checkInYearCol, row), inM = Reader::int32At(*checkInMonthCol, row),
+                  inD = Reader::int32At(*checkInDayCol, row);
+        const int outY = Reader::int32At(*checkOutYearCol, row), outM = Reader::int32At(*checkOutMonthCol, row),
+                  outD = Reader::int32At(*checkOutDayCol, row);
+        if (!isValidCivil(inY, inM, inD) || !isValidCivil(outY, outM, outD)) {
+            cerr << "Skipping invoice with invalid dates: " << rec.invoiceId << "\n";
+            rec = Invoice();
+            continue;
+        }
+        rec.checkIn = daysFromCivil(inY, inM, inD);
+        rec.checkOut = daysFromCivil(outY, outM, outD);
+        rec.roomCharge = Reader::float64At(*roomChargeCol, row);
+        rec.serviceCharge = Reader::float64At(*serviceChargeCol, row);
+        rec.totalAmount = Reader::float64At(*totalAmountCol, row);
+        invoiceIndex[rec.invoiceId] = count;
+        count++;
+    }
+    return true;
+}
+
+bool InvoiceManager::checkpointInBackground() {
+    if (!snapshotWriter) return false;
+
+    auto image = make_shared<vector<Invoice>>();
+    image->reserve(count - deleted.count());
+    forEachInvoice([&image](const Invoice& inv) { image->push_back(inv); });
+
+    const bool binary = storageFormat == StorageFormat::Binary;
+    return snapshotWriter->scheduleCheckpoint(oplog, checkpointPath(), [image, binary](ostream& file) {
+        vector<const Invoice*> list;
+        list.reserve(image->size());
+        for (const Invoice& inv : *image) list.push_back(&inv);
+        return binary ? writeInvoicesBinary(file, list) : writeInvoices(file, list);
+    });
+}
+
+void InvoiceManager::setSnapshotWriter(SnapshotWriter* writer) {
+    snapshotWriter = writer;
+}
+
+void InvoiceManager::maybeCheckpoint() {
+    // A checkpoint now could capture changes a transaction may still roll back.
+    if (oplog.isStaging()) return;
+    if (oplog.getRecordCount() < OperationLog::CHECKPOINT_INTERVAL) return;
+    if (snapshotWriter) checkpointInBackground();
+    else saveToFile();
+}
+
+void InvoiceManager::logPut(Invoice& invoice) {
+    invoice.jsonCache.invalidate();
+    invoice.revision = ++version;
+    oplog.appendPut(invoice.invoiceId, invoice.toJson());
+    maybeCheckpoint();
+}
+
+void InvoiceManager::logDelete(const string& invoiceId) {
+    ++version;
+    oplog.appendDelete(invoiceId);
+    maybeCheckpoint();
+}
+
+void InvoiceManager::applyLogRecord(OperationLog::Op op, const string& payload) {
+    if (op == OperationLog::Op::Delete) {
+        auto it = invoiceIndex.find(payload);
+        if (it == invoiceIndex.end()) return;
+        removeAt(it->second);
+        compactIfDue();
+        return;
+    }
+
+    Invoice parsed;
+    JsonReader reader(payload);
+    if (!reader.nextObject() || !readInvoice(reader, parsed)) {
+        cerr << "Skipping invalid invoice log record\n";
+        return;
+    }
+    if (parsed.invoiceId.empty()) return;
+    parsed.revision = ++version;
+
+    auto it = invoiceIndex.find(parsed.invoiceId);
+    if (it != invoiceIndex.end()) {
+        invoices[it->second] = parsed;
+        return;
+    }
+    if (count == capacity) resize();
+    invoices[count] = parsed;
+    invoiceIndex[parsed.invoiceId] = count;
+    count++;
 }
 
 bool InvoiceManager::checkOut(string roomId, RoomManager& roomMgr, ReservationManager& resMgr) {
@@ -96,16 +318,11 @@ bool InvoiceManager::checkOut(string roomId, RoomManager& roomMgr, ReservationMa
 
     invoices[count].invoiceId = "INV" + to_string(count + 1);
     invoices[count].customerId = res->customerId;
-    invoices[count].roomId = roomId;
-    invoices[count].checkInDay = res->checkInDay;
-    invoices[count].checkInMonth = res->checkInMonth;
-    invoices[count].checkInYear = res->checkInYear;
-    invoices[count].checkOutDay = res->checkOutDay;
-    invoices[count].checkOutMonth = res->checkOutMonth;
-    invoices[count].checkOutYear = res->checkOutYear;
+    invoices[count].roomId = room->roomId;
+    invoices[count].checkIn = res->checkIn;
+    invoices[count].checkOut = res->checkOut;
     
-    int days = calculateDays(res->checkInDay, res->checkInMonth, res->checkInYear,
-                            res->checkOutDay, res->checkOutMonth, res->checkOutYear);
+    int days = calculateDays(res->checkIn, res->checkOut);
     
     invoices[count].roomCharge = days * room->pricePerDay;
     invoices[count].serviceCharge = ServiceManagement::calculateServiceCharge(roomMgr, roomId);
@@ -113,8 +330,8 @@ bool InvoiceManager::checkOut(string roomId, RoomManager& roomMgr, ReservationMa
     
     cout << "\n========== HOA DON ==========\n";
     cout << "Ma hoa don: " << invoices[count].invoiceId << endl;
-    cout << "Ma khach: " << invoices[count].customerId << endl;
-    cout << "Ma phong: " << invoices[count].roomId << endl;
+    cout << "Ma khach: " << invoices[count].customerId.str() << endl;
+    cout << "Ma phong: " << invoices[count].roomId.str() << endl;
     cout << "So ngay thue: " << days << endl;
     cout << "Tien phong: " << fixed << setprecision(3) << invoices[count].roomCharge << endl;
     cout << "Tien dich vu: " << fixed << setprecision(3) << invoices[count].serviceCharge << endl;
@@ -127,53 +344,48 @@ bool InvoiceManager::checkOut(string roomId, RoomManager& roomMgr, ReservationMa
     // Mark room available (also clears services + persists)
     roomMgr.updateRoomStatus(roomId, true);
     
-    saveToFile();
+    logPut(invoices[count - 1]);
     return true;
 }
 
 int InvoiceManager::syncFromReservations(ReservationManager& resMgr, RoomManager& roomMgr) {
     int created = 0;
-    Reservation* rs = resMgr.getReservations();
-    int rn = resMgr.getReservationCount();
-    for (int i = 0; i < rn; ++i) {
-        Reservation& r = rs[i];
-        std::string status = r.status;
-        if (status != "checkedOut") continue;
-        if (existsForReservation(r)) continue;
+    resMgr.forEachReservation([&](Reservation& r) {
+        if (r.status != ReservationStatus::CheckedOut) return;
+        if (existsForReservation(r)) return;
 
         Room* room = roomMgr.findRoom(r.roomId);
         if (!room) {
             // If room not found, skip creating invoice for this reservation
-            continue;
+            return;
         }
         if (count == capacity) resize();
 
         invoices[count].invoiceId = "INV" + to_string(count + 1);
         invoices[count].customerId = r.customerId;
         invoices[count].roomId = r.roomId;
-        invoices[count].checkInDay = r.checkInDay;
-        invoices[count].checkInMonth = r.checkInMonth;
-        invoices[count].checkInYear = r.checkInYear;
-        invoices[count].checkOutDay = r.checkOutDay;
-        invoices[count].checkOutMonth = r.checkOutMonth;
-        invoices[count].checkOutYear = r.checkOutYear;
-
-        int days = calculateDays(r.checkInDay, r.checkInMonth, r.checkInYear,
-                                 r.checkOutDay, r.checkOutMonth, r.checkOutYear);
+        invoices[count].checkIn = r.checkIn;
+        invoices[count].checkOut = r.checkOut;
+
+        int days = calculateDays(r.checkIn, r.checkOut);
         invoices[count].roomCharge = days * room->pricePerDay;
         // Services may have been cleared; calculate current services if any
-        invoices[count].serviceCharge = ServiceManagement::calculateServiceCharge(roomMgr, r.roomId);
+        invoices[count].serviceCharge = ServiceManagement::calculateServiceCharge(*room);
         invoices[count].totalAmount = invoices[count].roomCharge + invoices[count].serviceCharge;
 
         invoiceIndex[invoices[count].invoiceId] = count;
         count++;
         created++;
-    }
-    if (created > 0) saveToFile();
+        logPut(invoices[count - 1]);
+    });
     return created;
 }
 
 void InvoiceManager::sortByTotal(bool ascending) {
+    if (deleted.count() > 0) {
+        count = deleted.compact(invoices, count);
+        rebuildIndex();
+    }
     if (count <= 1) return;
     if (ascending) {
         std::sort(invoices, invoices + count, [](const Invoice& a, const Invoice& b) {
@@ -190,9 +402,14 @@ void InvoiceManager::sortByTotal(bool ascending) {
 }
 
 double InvoiceManager::calculateRevenue(int month, int year) {
+    if (month < 1 || month > 12) return 0;
+    // The month is the day range [first, next month's first).
+    const DayNumber first = daysFromCivil(year, month, 1);
+    const DayNumber end = month == 12 ? daysFromCivil(year + 1, 1, 1) : daysFromCivil(year, month + 1, 1);
     double total = 0;
     for (int i = 0; i < count; i++) {
-        if (invoices[i].checkOutMonth == month && invoices[i].checkOutYear == year) {
+        if (deleted.isDead(i)) continue;
+        if (invoices[i].checkOut >= first && invoices[i].checkOut < end) {
             total += invoices[i].totalAmount;
         }
     }
@@ -200,58 +417,79 @@ double InvoiceManager::calculateRevenue(int month, int year) {
 }
 
 
-void InvoiceManager::loadFromJson(const string& json) {
-    size_t pos = 1;
-    while (pos < json.length()) {
-        size_t start = json.find("{", pos);
-        if (start == string::npos) break;
-        
-        size_t end = json.find("}", start);
-        if (end == string::npos) break;
-        
-        string obj = json.substr(start, end - start + 1);
-        
-        if (count == capacity) resize();
-        
-        invoices[count].invoiceId = JsonHelper::extractValue(obj, "invoiceId");
-        invoices[count].customerId = JsonHelper::extractValue(obj, "customerId");
-        invoices[count].roomId = JsonHelper::extractValue(obj, "roomId");
-        invoices[count].checkInDay = stoi(JsonHelper::extractValue(obj, "checkInDay"));
-        invoices[count].checkInMonth = stoi(JsonHelper::extractValue(obj, "checkInMonth"));
-        invoices[count].checkInYear = stoi(JsonHelper::extractValue(obj, "checkInYear"));
-        invoices[count].checkOutDay = stoi(JsonHelper::extractValue(obj, "checkOutDay"));
-        invoices[count].checkOutMonth = stoi(JsonHelper::extractValue(obj, "checkOutMonth"));
-        invoices[count].checkOutYear = stoi(JsonHelper::extractValue(obj, "checkOutYear"));
-        invoices[count].roomCharge = stod(JsonHelper::extractValue(obj, "roomCharge"));
-        invoices[count].serviceCharge = stod(JsonHelper::extractValue(obj, "serviceCharge"));
-        invoices[count].totalAmount = stod(JsonHelper::extractValue(obj, "totalAmount"));
-        
-        invoiceIndex[invoices[count].invoiceId] = count;
-        count++;
-        pos = end + 1;
+// Parses one chunk of invoices.json; malformed records are skipped.
+static void parseInvoiceChunk(std::string_view chunk, vector<Invoice>& out) {
+    JsonReader reader(chunk);
+    while (reader.nextObject()) {
+        Invoice inv;
+        if (!readInvoice(reader, inv)) {
+            cerr << "Skipping invalid invoice record\n";
+            if (reader.failed()) break;
+            continue;
+        }
+        out.push_back(std::move(inv));
     }
 }
 
-void InvoiceManager::loadFromFile() {
-    ifstream file(INVOICE_FILE);
-    if (!file.is_open()) {
-        return;
+void InvoiceManager::loadFromJson(const string& json, ThreadPool* pool) {
+    vector<vector<Invoice>> parts = parseJsonArrayChunks<Invoice>(json, pool, parseInvoiceChunk);
+
+    size_t total = 0;
+    for (const auto& part : parts) total += part.size();
+    while (capacity < count + static_cast<int>(total)) resize();
+    invoiceIndex.reserve(count + total);
+
+    for (auto& part : parts) {
+        for (Invoice& inv : part) {
+            invoices[count] = std::move(inv);
+            invoiceIndex[invoices[count].invoiceId] = count;
+            count++;
+        }
     }
-    
-    stringstream buffer;
-    buffer << file.rdbuf();
-    string json = buffer.str();
-    file.close();
-    
-    loadFromJson(json);
+}
+
+void InvoiceManager::loadFromFile(ThreadPool* pool) {
+    ifstream file;
+    if (!binarySnapshotIsCurrent(INVOICE_FILE) || !loadFromBinary(binarySnapshotPath(INVOICE_FILE))) {
+        file.open(INVOICE_FILE);
+    }
+    const bool importedJson = file.is_open();
+    if (importedJson) {
+        stringstream buffer;
+        buffer << file.rdbuf();
+        string json = buffer.str();
+        file.close();
+
+        loadFromJson(json, pool);
+    }
+
+    oplog.replay([this](OperationLog::Op op, const string& payload) {
+        applyLogRecord(op, payload);
+    });
+
+    // First start in binary mode: convert the imported JSON right away.
+    if (importedJson && storageFormat == StorageFormat::Binary) saveToFile();
 }
 
 int InvoiceManager::getInvoiceCount() {
-    return count;
+    return count - deleted.count();
 }
 
-Invoice* InvoiceManager::getInvoices() {
-    return invoices;
+OperationLog& InvoiceManager::getOperationLog() {
+    return oplog;
+}
+
+std::shared_mutex& InvoiceManager::getMutex() const {
+    return storeMutex;
+}
+
+uint64_t InvoiceManager::getVersion() const {
+    return version.load();
+}
+
+void InvoiceManager::restoreRecord(OperationLog::Op op, const string& payload) {
+    applyLogRecord(op, payload);
+    ++version;
 }
 
 Invoice* InvoiceManager::findInvoiceById(const string& invoiceId) {
@@ -265,40 +503,36 @@ Invoice* InvoiceManager::findInvoiceById(const string& invoiceId) {
 int InvoiceManager::rebuildFromReservationsStrict(ReservationManager& resMgr, RoomManager& roomMgr) {
     // Reset current invoices
     count = 0;
+    deleted.clear();
     invoiceIndex.clear();
 
-    Reservation* rs = resMgr.getReservations();
-    int rn = resMgr.getReservationCount();
     int created = 0;
-    for (int i = 0; i < rn; ++i) {
-        Reservation& r = rs[i];
-        std::string status = r.status;
-        if (status != "checkedOut") continue;
+    resMgr.forEachReservation([&](Reservation& r) {
+        if (r.status != ReservationStatus::CheckedOut) return;
 
         Room* room = roomMgr.findRoom(r.roomId);
-        if (!room) continue;
+        if (!room) return;
         if (count == capacity) resize();
 
+        // The slot may still hold a replaced invoice: start from a blank record
+        // with a fresh revision, so no earlier ETag matches it.
+        invoices[count] = Invoice();
+        invoices[count].revision = ++version;
         invoices[count].invoiceId = "INV" + to_string(count + 1);
         invoices[count].customerId = r.customerId;
         invoices[count].roomId = r.roomId;
-        invoices[count].checkInDay = r.checkInDay;
-        invoices[count].checkInMonth = r.checkInMonth;
-        invoices[count].checkInYear = r.checkInYear;
-        invoices[count].checkOutDay = r.checkOutDay;
-        invoices[count].checkOutMonth = r.checkOutMonth;
-        invoices[count].checkOutYear = r.checkOutYear;
-
-        int days = calculateDays(r.checkInDay, r.checkInMonth, r.checkInYear,
-                                 r.checkOutDay, r.checkOutMonth, r.checkOutYear);
+        invoices[count].checkIn = r.checkIn;
+        invoices[count].checkOut = r.checkOut;
+
+        int days = calculateDays(r.checkIn, r.checkOut);
         invoices[count].roomCharge = days * room->pricePerDay;
-        invoices[count].serviceCharge = ServiceManagement::calculateServiceCharge(roomMgr, r.roomId);
+        invoices[count].serviceCharge = ServiceManagement::calculateServiceCharge(*room);
         invoices[count].totalAmount = invoices[count].roomCharge + invoices[count].serviceCharge;
 
         invoiceIndex[invoices[count].invoiceId] = count;
         count++;
         created++;
-    }
+    });
     saveToFile();
     return created;
 }
@@ -320,7 +554,7 @@ bool InvoiceManager::addInvoice(const Invoice& invoice) {
     invoiceIndex[invoices[count].invoiceId] = count;
     count++;
 
-    saveToFile();
+    logPut(invoices[count - 1]);
     return true;
 }
 
@@ -334,11 +568,8 @@ bool InvoiceManager::deleteInvoice(const string& invoiceId) {
         return false;
     }
 
-    for (int i = idx; i < count - 1; ++i) {
-        invoices[i] = invoices[i + 1];
-    }
-    --count;
-    rebuildIndex();
-    saveToFile();
+    removeAt(idx);
+    logDelete(invoiceId);
+    compactIfDue();
     return true;
 }
\ No newline at end of file
@@ -0,0 +1,281 @@
+#include "JsonReader.h"
+
+#include <charconv>
+
+JsonReader::JsonReader(std::string_view text) : text(text), pos(0), inObject(false), error(false) {}
+
+bool JsonReader::failed() const {
+    return error;
+}
+
+size_t JsonReader::position() const {
+    return pos;
+}
+
+void JsonReader::skipWhitespace() {
+    while (pos < text.size()) {
+        char c = text[pos];
+        if (c != ' ' && c != '\n' && c != '\r' && c != '\t') break;
+        ++pos;
+    }
+}
+
+bool JsonReader::nextObject() {
+    if (error) return false;
+    // Finish an object the caller did not read to the end.
+    JsonField ignored;
+    while (inObject && nextField(ignored)) {}
+    if (error) return false;
+
+    while (pos < text.size()) {
+        char c = text[pos];
+        if (c == '{') {
+            ++pos;
+            inObject = true;
+            return true;
+        }
+        if (c == ']') return false;
+        if (c == '[' || c == ',' || c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+            ++pos;
+            continue;
+        }
+        error = true;
+        return false;
+    }
+    return false;
+}
+
+bool JsonReader::scanString(std::string_view& out, bool& hasEscapes) {
+    // pos is on the opening quote
+    size_t start = ++pos;
+    hasEscapes = false;
+    while (pos < text.size()) {
+        char c = text[pos];
+        if (c == '"') {
+            out = text.substr(start, pos - start);
+            ++pos;
+            return true;
+        }
+        if (c == '\\') {
+            hasEscapes = true;
+            ++pos;
+        }
+        ++pos;
+    }
+    error = true;
+    return false;
+}
+
+bool JsonReader::skipNested() {
+    int depth = 0;
+    while (pos < text.size()) {
+        char c = text[pos];
+        if (c == '"') {
+            std::string_view ignored;
+            bool esc;
+            if (!scanString(ignored, esc)) return false;
+            continue;
+        }
+        if (c == '{' || c == '[') ++depth;
+        else if (c == '}' || c == ']') {
+            --depth;
+            if (depth == 0) {
+                ++pos;
+                return true;
+            }
+        }
+        ++pos;
+    }
+    error = true;
+    return false;
+}
+
+bool JsonReader::nextField(JsonField& field) {
+    if (!inObject || error) return false;
+
+    skipWhitespace();
+    if (pos < text.size() && text[pos] == ',') {
+        ++pos;
+        skipWhitespace();
+    }
+    if (pos >= text.size()) {
+        error = true;
+        return false;
+    }
+    if (text[pos] == '}') {
+        ++pos;
+        inObject = false;
+        return false;
+    }
+    if (text[pos] != '"') {
+        error = true;
+        return false;
+    }
+
+    bool keyEscapes;
+    if (!scanString(field.key, keyEscapes)) return false;
+    skipWhitespace();
+    if (pos >= text.size() || text[pos] != ':') {
+        error = true;
+        return false;
+    }
+    ++pos;
+    skipWhitespace();
+    if (pos >= text.size()) {
+        error = true;
+        return false;
+    }
+
+    char c = text[pos];
+    if (c == '"') {
+        field.isString = true;
+        return scanString(field.raw, field.hasEscapes);
+    }
+
+    field.isString = false;
+    field.hasEscapes = false;
+    size_t start = pos;
+    if (c == '{' || c == '[') {
+        if (!skipNested()) return false;
+    } else {
+        while (pos < text.size()) {
+            char v = text[pos];
+            if (v == ',' || v == '}' || v == ' ' || v == '\n' || v == '\r' || v == '\t') break;
+            ++pos;
+        }
+    }
+    field.raw = text.substr(start, pos - start);
+    return true;
+}
+
+bool JsonReader::toInt(const JsonField& field, int& out) {
+    const char* first = field.raw.data();
+    const char* last = first + field.raw.size();
+    auto res = std::from_chars(first, last, out);
+    if (res.ec != std::errc()) return false;
+    // Accept integral values written as doubles ("3.0").
+    if (res.ptr != last) {
+        double d;
+        if (!toDouble(field, d)) return false;
+        out = static_cast<int>(d);
+    }
+    return true;
+}
+
+bool JsonReader::toDouble(const JsonField& field, double& out) {
+    const char* first = field.raw.data();
+    const char* last = first + field.raw.size();
+    auto res = std::from_chars(first, last, out);
+    return res.ec == std::errc() && res.ptr == last;
+}
+
+bool JsonReader::toBool(const JsonField& field, bool& out) {
+    if (field.raw == "true") out = true;
+    else if (field.raw == "false") out = false;
+    else return false;
+    return true;
+}
+
+static void appendUtf8(std::string& out, unsigned cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+static bool parseHex4(std::string_view s, size_t at, unsigned& cp) {
+    if (at + 4 > s.size()) return false;
+    auto res = std::from_chars(s.data() + at, s.data() + at + 4, cp, 16);
+    return res.ec == std::errc() && res.ptr == s.data() + at + 4;
+}
+
+void JsonReader::toString(const JsonField& field, std::string& out) {
+    if (!field.hasEscapes) {
+        out.assign(field.raw.data(), field.raw.size());
+        return;
+    }
+
+    const std::string_view s = field.raw;
+    out.clear();
+    out.reserve(s.size());
+    for (size_t i = 0; i < s.size(); ++i) {
+        char c = s[i];
+        if (c != '\\' || i + 1 >= s.size()) {
+            out += c;
+            continue;
+        }
+        char e = s[++i];
+        switch (e) {
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'u': {
+                unsigned cp;
+                if (!parseHex4(s, i + 1, cp)) {
+                    out += e;
+                    break;
+                }
+                i += 4;
+                unsigned low;
+                if (cp >= 0xD800 && cp <= 0xDBFF && i + 2 < s.size() && s[i + 1] == '\\' &&
+                    s[i + 2] == 'u' && parseHex4(s, i + 3, low) && low >= 0xDC00 && low <= 0xDFFF) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    i += 6;
+                }
+                appendUtf8(out, cp);
+                break;
+            }
+            default: out += e; break; // \" \\ \/
+        }
+    }
+}
+
+std::vector<std::string_view> JsonReader::splitArray(std::string_view text, size_t parts) {
+    std::vector<std::string_view> chunks;
+    if (parts <= 1 || text.empty()) {
+        chunks.push_back(text);
+        return chunks;
+    }
+
+    const size_t step = text.size() / parts;
+    size_t nextSplit = step;
+    size_t chunkStart = 0;
+    int depth = 0;
+    bool inString = false;
+    for (size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (inString) {
+            if (c == '\\') ++i;
+            else if (c == '"') inString = false;
+            continue;
+        }
+        if (c == '"') {
+            inString = true;
+        } else if (c == '{' || c == '[') {
+            // Only cut in front of an object that sits directly in the top-level array.
+            if (c == '{' && depth == 1 && i >= nextSplit && i > chunkStart) {
+                chunks.push_back(text.substr(chunkStart, i - chunkStart));
+                chunkStart = i;
+                nextSplit = i + step;
+            }
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            --depth;
+        }
+    }
+    chunks.push_back(text.substr(chunkStart));
+    return chunks;
+}
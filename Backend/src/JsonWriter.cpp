@@ -0,0 +1,171 @@
+#include "JsonWriter.h"
+
+#include <charconv>
+#include <cmath>
+
+JsonWriter::JsonWriter(std::string& out, Style style, int baseIndent)
+    : out(out), style(style), baseIndent(baseIndent), afterKey(false) {
+    stack.reserve(8);
+}
+
+std::string& JsonWriter::buffer() {
+    return out;
+}
+
+void JsonWriter::newline(int indent) {
+    out += '\n';
+    out.append(static_cast<size_t>(indent), ' ');
+}
+
+void JsonWriter::beforeValue() {
+    if (afterKey) {
+        afterKey = false;
+        return;
+    }
+    if (stack.empty()) return;
+    Frame& f = stack.back();
+    if (!f.first) out += ',';
+    f.first = false;
+    if (style == Style::File) newline(f.childIndent);
+}
+
+void JsonWriter::open(bool isObject, char bracket) {
+    beforeValue();
+    // Position of the container: the current child column, or baseIndent at top level.
+    const int pos = stack.empty() ? baseIndent : stack.back().childIndent;
+    Frame f;
+    f.isObject = isObject;
+    f.first = true;
+    f.closeIndent = pos;
+    // Objects indent their fields; nested arrays keep their elements at the key's
+    // column, matching the "services": [ ... ] layout of rooms.json.
+    f.childIndent = (isObject || stack.empty()) ? pos + 2 : pos;
+    stack.push_back(f);
+    out += bracket;
+}
+
+void JsonWriter::close(char bracket) {
+    if (stack.empty()) return;
+    const Frame f = stack.back();
+    stack.pop_back();
+    if (style == Style::File && !f.first) newline(f.closeIndent);
+    out += bracket;
+}
+
+void JsonWriter::beginObject() {
+    open(true, '{');
+}
+
+void JsonWriter::endObject() {
+    close('}');
+}
+
+void JsonWriter::beginArray() {
+    open(false, '[');
+}
+
+void JsonWriter::endArray() {
+    close(']');
+}
+
+void JsonWriter::key(std::string_view name) {
+    beforeValue();
+    out += '"';
+    appendEscaped(out, name);
+    out += (style == Style::File) ? "\": " : "\":";
+    afterKey = true;
+}
+
+void JsonWriter::value(std::string_view s) {
+    beforeValue();
+    out += '"';
+    appendEscaped(out, s);
+    out += '"';
+}
+
+void JsonWriter::value(const char* s) {
+    value(std::string_view(s));
+}
+
+void JsonWriter::value(int v) {
+    beforeValue();
+    char buf[16];
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, res.ptr);
+}
+
+void JsonWriter::value(double v) {
+    beforeValue();
+    if (!std::isfinite(v)) {
+        out += "null";
+        return;
+    }
+    char buf[64];
+    if (style == Style::File) {
+        // Same text as JsonHelper::formatPrice.
+        auto res = std::to_chars(buf, buf + sizeof(buf), v, std::chars_format::fixed, 3);
+        out.append(buf, res.ptr);
+        return;
+    }
+    // Shortest round-trip form; keep a ".0" on integral values like nlohmann does.
+    auto res = std::to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, res.ptr);
+    bool integral = true;
+    for (const char* p = buf; p != res.ptr; ++p) {
+        if (*p == '.' || *p == 'e') {
+            integral = false;
+            break;
+        }
+    }
+    if (integral) out += ".0";
+}
+
+void JsonWriter::value(bool v) {
+    beforeValue();
+    out += v ? "true" : "false";
+}
+
+void JsonWriter::null() {
+    beforeValue();
+    out += "null";
+}
+
+void JsonWriter::raw(std::string_view json) {
+    beforeValue();
+    out += json;
+}
+
+void JsonWriter::rawFields(std::string_view members) {
+    if (members.empty() || stack.empty()) return;
+    Frame& f = stack.back();
+    if (!f.first) out += ',';
+    f.first = false;
+    out += members;
+}
+
+void JsonWriter::appendEscaped(std::string& out, std::string_view s) {
+    static const char hex[] = "0123456789abcdef";
+    size_t clean = 0;
+    for (size_t i = 0; i < s.size(); ++i) {
+        const unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        out.append(s.data() + clean, i - clean);
+        clean = i + 1;
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            default:
+                out += "\\u00";
+                out += hex[c >> 4];
+                out += hex[c & 0xF];
+                break;
+        }
+    }
+    out.append(s.data() + clean, s.size() - clean);
+}
@@ -0,0 +1,368 @@
+#include "OperationLog.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+OperationLog::OperationLog(std::string path)
+    : logPath(std::move(path)), durability(Durability::None), recordCount(0), buffered(false), staging(nullptr),
+      queuedMark(0), flushedMark(0), lostMark(0), rotatedMark(0), lastTransaction(0) {}
+
+OperationLog::~OperationLog() {
+    flushPending();
+    out.close();
+}
+
+void OperationLog::setPath(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (path == logPath) return;
+    out.close();
+    logPath = path;
+    pending.clear();
+    pendingIndex.clear();
+    recordCount = 0;
+    flushedMark = queuedMark;
+    lostMark = 0;
+}
+
+const std::string& OperationLog::getPath() const {
+    return logPath;
+}
+
+void OperationLog::setDurability(Durability level) {
+    std::lock_guard<std::mutex> lock(mtx);
+    durability = level;
+    out.close();
+}
+
+Durability OperationLog::getDurability() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return durability;
+}
+
+bool OperationLog::appendPut(const std::string& id, const std::string& payload) {
+    return append(Op::Put, id, payload);
+}
+
+bool OperationLog::appendDelete(const std::string& id) {
+    return append(Op::Delete, id, id);
+}
+
+void OperationLog::setBuffered(bool enabled, std::function<void()> onAppend) {
+    if (!enabled) flushPending();
+    std::lock_guard<std::mutex> lock(mtx);
+    buffered = enabled;
+    appendListener = enabled ? std::move(onAppend) : nullptr;
+}
+
+bool OperationLog::isBuffered() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return buffered;
+}
+
+bool OperationLog::openForAppend() {
+    if (out.isOpen()) return true;
+    std::error_code ec;
+    const bool created = !std::filesystem::exists(logPath, ec);
+    if (!out.openAppend(logPath, durability == Durability::DSync)) {
+        std::cout << "Loi: Khong the ghi nhat ky " << logPath << "!\n";
+        return false;
+    }
+    // A synced record is only durable once the new file's directory entry is.
+    if (created && !syncDirectoryLocked()) {
+        out.close();
+        return false;
+    }
+    return true;
+}
+
+bool OperationLog::syncDirectoryLocked() {
+    return durability == Durability::None || DurableFile::syncParentDirectory(logPath);
+}
+
+void OperationLog::appendFrame(std::string& out, Op op, const std::string& payload) {
+    out += static_cast<char>(op);
+    out += ' ';
+    out += std::to_string(payload.size());
+    out += '\n';
+    out += payload;
+    out += '\n';
+}
+
+bool OperationLog::append(Op op, const std::string& id, const std::string& payload) {
+    std::function<void()> listener;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (staging) {
+            staging->push_back({op, id, payload});
+            return true;
+        }
+        if (!buffered && pending.empty()) {
+            std::string record;
+            record.reserve(payload.size() + 24);
+            appendFrame(record, op, payload);
+            ++recordCount;
+            if (!openForAppend()) return false;
+            if (!out.write(record.data(), record.size())) return false;
+            // Unbuffered, every append is its own batch.
+            if (durability == Durability::FsyncPerBatch || durability == Durability::FsyncPerOp) {
+                return out.sync();
+            }
+            return true;
+        }
+
+        queueLocked(op, id, payload);
+        // Unbuffered with enqueued records: they go out in the same write.
+        if (!buffered) return writePendingLocked();
+        listener = appendListener;
+    }
+    if (listener) listener();
+    return true;
+}
+
+void OperationLog::queueLocked(Op op, const std::string& id, const std::string& payload) {
+    ++queuedMark;
+    // Transaction markers are not records: they don't count towards checkpoints.
+    const int counted = op == Op::Commit ? 0 : 1;
+    auto it = pendingIndex.find(id);
+    if (it != pendingIndex.end()) {
+        PendingRecord& slot = pending[it->second];
+        if (op == Op::Put && slot.op == Op::Put) {
+            // Still dirty since the last flush: just take the newer contents.
+            slot.payload = payload;
+            return;
+        }
+        // A delete (or a re-insert after one) must land after the records
+        // that preceded it, so retire the old slot and append a new one.
+        slot.live = false;
+        if (slot.op != Op::Commit) --recordCount;
+    }
+    pendingIndex[id] = pending.size();
+    pending.push_back({op, payload, true});
+    recordCount += counted;
+}
+
+std::uint64_t OperationLog::enqueue(const std::vector<StagedRecord>& records, std::uint64_t transaction) {
+    std::function<void()> listener;
+    std::uint64_t mark;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        for (const StagedRecord& rec : records) queueLocked(rec.op, rec.id, rec.payload);
+        // Record ids are never empty, so "" keys the marker; a newer one
+        // retires the older and lands after both transactions' records.
+        queueLocked(Op::Commit, std::string(), std::to_string(transaction));
+        if (transaction > lastTransaction) lastTransaction = transaction;
+        mark = queuedMark;
+        if (buffered) listener = appendListener;
+    }
+    if (listener) listener();
+    return mark;
+}
+
+bool OperationLog::isFlushedThrough(std::uint64_t mark) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return mark <= flushedMark;
+}
+
+bool OperationLog::flushPending() {
+    std::lock_guard<std::mutex> lock(mtx);
+    return writePendingLocked();
+}
+
+void OperationLog::setStaging(std::vector<StagedRecord>* sink) {
+    std::lock_guard<std::mutex> lock(mtx);
+    staging = sink;
+}
+
+bool OperationLog::isStaging() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return staging != nullptr;
+}
+
+bool OperationLog::writePendingLocked() {
+    if (pending.empty()) return true;
+    const std::uint64_t through = queuedMark;
+    if (!openForAppend()) {
+        // The records stay queued; the next flush retries them.
+        return false;
+    }
+
+    std::string batch;
+    bool ok = true;
+    if (durability == Durability::FsyncPerOp) {
+        // Each record is on disk before the next one is written.
+        for (const PendingRecord& rec : pending) {
+            if (!rec.live) continue;
+            batch.clear();
+            appendFrame(batch, rec.op, rec.payload);
+            ok = ok && out.write(batch.data(), batch.size()) && out.sync();
+        }
+    } else {
+        size_t bytes = 0;
+        for (const PendingRecord& rec : pending) bytes += rec.payload.size() + 24;
+        batch.reserve(bytes);
+        for (const PendingRecord& rec : pending) {
+            if (rec.live) appendFrame(batch, rec.op, rec.payload);
+        }
+        ok = out.write(batch.data(), batch.size());
+        if (ok && durability == Durability::FsyncPerBatch) ok = out.sync();
+    }
+    pending.clear();
+    pendingIndex.clear();
+    if (!ok && lostMark == 0) lostMark = through;
+    if (ok && lostMark == 0) flushedMark = through;
+    return ok;
+}
+
+std::string OperationLog::rotatedPath() const {
+    return logPath + ".1";
+}
+
+int OperationLog::replay(const std::function<void(Op, const std::string&)>& apply) {
+    std::lock_guard<std::mutex> lock(mtx);
+    out.close();
+
+    recordCount = replayFile(rotatedPath(), apply) + replayFile(logPath, apply);
+    return recordCount;
+}
+
+int OperationLog::replayFile(const std::string& path, const std::function<void(Op, const std::string&)>& apply) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return 0;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    const std::string data = buffer.str();
+    file.close();
+
+    size_t pos = 0;
+    size_t validEnd = 0;
+    int applied = 0;
+    while (pos < data.size()) {
+        const char op = data[pos];
+        if ((op != static_cast<char>(Op::Put) && op != static_cast<char>(Op::Delete) &&
+             op != static_cast<char>(Op::Commit)) ||
+            pos + 1 >= data.size() || data[pos + 1] != ' ') {
+            break;
+        }
+
+        size_t lineEnd = data.find('\n', pos + 2);
+        if (lineEnd == std::string::npos) break;
+
+        size_t len = 0;
+        bool validLen = lineEnd > pos + 2;
+        for (size_t i = pos + 2; i < lineEnd && validLen; ++i) {
+            if (data[i] < '0' || data[i] > '9') validLen = false;
+            else len = len * 10 + static_cast<size_t>(data[i] - '0');
+        }
+        if (!validLen) break;
+
+        const size_t payloadStart = lineEnd + 1;
+        if (payloadStart + len >= data.size() || data[payloadStart + len] != '\n') break;
+
+        if (op == static_cast<char>(Op::Commit)) {
+            const std::uint64_t transaction = std::strtoull(data.c_str() + payloadStart, nullptr, 10);
+            if (transaction > lastTransaction) lastTransaction = transaction;
+        } else {
+            apply(static_cast<Op>(op), data.substr(payloadStart, len));
+            ++applied;
+        }
+        pos = payloadStart + len + 1;
+        validEnd = pos;
+    }
+
+    if (validEnd < data.size()) {
+        std::cerr << "Operation log " << path << ": dropping " << (data.size() - validEnd)
+                  << " bytes of incomplete records\n";
+        std::error_code ec;
+        std::filesystem::resize_file(path, validEnd, ec);
+    }
+    return applied;
+}
+
+void OperationLog::truncate() {
+    std::lock_guard<std::mutex> lock(mtx);
+    out.close();
+    pending.clear();
+    pendingIndex.clear();
+    std::error_code ec;
+    std::filesystem::remove(logPath, ec);
+    std::filesystem::remove(rotatedPath(), ec);
+    syncDirectoryLocked();
+    recordCount = 0;
+    // The checkpoint that prompted this holds every queued record.
+    flushedMark = queuedMark;
+    lostMark = 0;
+    writeTransactionMarkerLocked();
+}
+
+bool OperationLog::writeTransactionMarkerLocked() {
+    if (lastTransaction == 0) return true;
+    std::string marker;
+    appendFrame(marker, Op::Commit, std::to_string(lastTransaction));
+    if (!openForAppend() || !out.write(marker.data(), marker.size())) return false;
+    if (durability == Durability::FsyncPerBatch || durability == Durability::FsyncPerOp) return out.sync();
+    return true;
+}
+
+bool OperationLog::rotate() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!writePendingLocked()) return false;
+    out.close();
+    recordCount = 0;
+    rotatedMark = queuedMark;
+
+    // The fresh live log starts with the last transaction marker, so it
+    // outlives the rotated segment.
+    return rotateFilesLocked() && syncDirectoryLocked() && writeTransactionMarkerLocked();
+}
+
+bool OperationLog::rotateFilesLocked() {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    if (!fs::exists(logPath, ec)) return true;
+    if (fs::file_size(logPath, ec) == 0) {
+        fs::remove(logPath, ec);
+        return true;
+    }
+
+    if (!fs::exists(rotatedPath(), ec)) {
+        fs::rename(logPath, rotatedPath(), ec);
+        return !ec;
+    }
+
+    // A previous checkpoint failed: keep its records and append ours after them.
+    std::ifstream in(logPath, std::ios::binary);
+    std::ofstream rotated(rotatedPath(), std::ios::binary | std::ios::app);
+    if (!in.is_open() || !rotated.is_open()) return false;
+    rotated << in.rdbuf();
+    rotated.close();
+    in.close();
+    if (!rotated) return false;
+    if (durability != Durability::None && !DurableFile::syncPath(rotatedPath())) return false;
+    fs::remove(logPath, ec);
+    return true;
+}
+
+void OperationLog::dropRotated() {
+    std::lock_guard<std::mutex> lock(mtx);
+    std::error_code ec;
+    std::filesystem::remove(rotatedPath(), ec);
+    syncDirectoryLocked();
+    // The checkpoint covers everything queued before rotate().
+    if (lostMark != 0 && lostMark <= rotatedMark) lostMark = 0;
+    if (rotatedMark > flushedMark) flushedMark = rotatedMark;
+}
+
+int OperationLog::getRecordCount() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return recordCount;
+}
+
+std::uint64_t OperationLog::getLastTransaction() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return lastTransaction;
+}
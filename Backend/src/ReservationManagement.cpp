@@ -1,14 +1,65 @@
 #include "ReservationManagement.h"
+#include "JsonReader.h"
+#include "ParallelParse.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <chrono>
+#include <memory>
+#include <vector>
 using namespace std;
 
-ReservationManager::ReservationManager(int cap) : capacity(cap), count(0) {
+ReservationManager::ReservationManager(int cap)
+    : capacity(cap), count(0), oplog(RESERVATION_FILE + ".log"), snapshotWriter(nullptr),
+      storageFormat(StorageFormat::Json), deferCheckpoints(false) {
     reservations = new Reservation[capacity];
 }
 
+// Ids are stored as keys; the JSON string goes through a temporary.
+template <class Key>
+static void readKey(const JsonField& f, Key& key) {
+    string id;
+    JsonReader::toString(f, id);
+    key = id;
+}
+
+// Fills a reservation from the reader's current object in a single pass.
+// Returns false if a numeric field is malformed, a date is not a calendar
+// date or the status is unknown.
+static bool readReservation(JsonReader& reader, Reservation& r) {
+    bool ok = true;
+    int inD = 0, inM = 0, inY = 0, outD = 0, outM = 0, outY = 0;
+    bool hasStatus = false;
+    bool checkedIn = false;
+    string status;
+    JsonField f;
+    while (reader.nextField(f)) {
+        if (f.key == "reservationId") JsonReader::toString(f, r.reservationId);
+        else if (f.key == "customerId") readKey(f, r.customerId);
+        else if (f.key == "roomId") readKey(f, r.roomId);
+        else if (f.key == "checkInDay") ok &= JsonReader::toInt(f, inD);
+        else if (f.key == "checkInMonth") ok &= JsonReader::toInt(f, inM);
+        else if (f.key == "checkInYear") ok &= JsonReader::toInt(f, inY);
+        else if (f.key == "checkOutDay") ok &= JsonReader::toInt(f, outD);
+        else if (f.key == "checkOutMonth") ok &= JsonReader::toInt(f, outM);
+        else if (f.key == "checkOutYear") ok &= JsonReader::toInt(f, outY);
+        else if (f.key == "status") {
+            JsonReader::toString(f, status);
+            hasStatus = !status.empty();
+        } else if (f.key == "isCheckedIn") {
+            checkedIn = (f.raw == "true");
+        }
+    }
+
+    // Try to load status (new format), fallback to isCheckedIn (old format)
+    if (hasStatus) ok &= parseReservationStatus(status, r.status);
+    else r.status = checkedIn ? ReservationStatus::CheckedIn : ReservationStatus::Pending;
+    ok &= isValidCivil(inY, inM, inD) && isValidCivil(outY, outM, outD);
+    r.checkIn = daysFromCivil(inY, inM, inD);
+    r.checkOut = daysFromCivil(outY, outM, outD);
+    return ok && !reader.failed();
+}
+
 ReservationManager::~ReservationManager() {
     delete[] reservations;
 }
@@ -26,30 +77,264 @@ void ReservationManager::resize() {
 
 void ReservationManager::rebuildIndex() {
     reservationIndex.clear();
-    for (int i = 0; i < count; ++i) reservationIndex[reservations[i].reservationId] = i;
+    activeByRoom.clear();
+    for (int i = 0; i < count; ++i) {
+        if (deleted.isDead(i)) continue;
+        reservationIndex[reservations[i].reservationId] = i;
+        trackActive(i);
+    }
+}
+
+// Adds the slot to its room's active list if the reservation is active.
+// New slots are the highest, so the append keeps the list in storage order.
+void ReservationManager::trackActive(int slot) {
+    const size_t room = reservations[slot].roomId.index();
+    if (room >= activeByRoom.size()) activeByRoom.resize(RoomIds::dictionary().size());
+    if (!isActiveStatus(reservations[slot].status)) return;
+    SmallVector<int, 2>& slots = activeByRoom[room];
+    size_t pos = slots.size();
+    while (pos > 0 && slots[pos - 1] > slot) --pos;
+    slots.insert(pos, slot);
+}
+
+void ReservationManager::untrackActive(int slot) {
+    const size_t room = reservations[slot].roomId.index();
+    if (room >= activeByRoom.size()) return;
+    SmallVector<int, 2>& slots = activeByRoom[room];
+    for (size_t i = 0; i < slots.size(); ++i) {
+        if (slots[i] == slot) {
+            slots.erase(i);
+            return;
+        }
+    }
+}
+
+void ReservationManager::setStatus(int slot, ReservationStatus status) {
+    untrackActive(slot);
+    reservations[slot].status = status;
+    trackActive(slot);
+}
+
+// O(1): the slot becomes a tombstone and only this id leaves the index.
+void ReservationManager::removeAt(int slot) {
+    reservationIndex.erase(reservations[slot].reservationId);
+    untrackActive(slot);
+    reservations[slot] = Reservation();
+    deleted.mark(slot);
+}
+
+// Runs only from delete paths, which hold the store exclusively: moving
+// reservations would invalidate pointers a shared-lock caller still holds.
+void ReservationManager::compactIfDue() {
+    if (!deleted.compactionDue(count)) return;
+    count = deleted.compact(reservations, count);
+    rebuildIndex();
+}
+
+vector<const Reservation*> ReservationManager::liveReservations() const {
+    vector<const Reservation*> list;
+    list.reserve(count - deleted.count());
+    for (int i = 0; i < count; ++i) {
+        if (!deleted.isDead(i)) list.push_back(&reservations[i]);
+    }
+    return list;
+}
+
+static bool writeReservations(ostream& file, const vector<const Reservation*>& reservations) {
+    return JsonWriter::writeFileArray(file, reservations.size(), [&](size_t i, JsonWriter& w) {
+        reservations[i]->writeJson(w);
+    });
+}
+
+static bool writeReservationsBinary(ostream& file, const vector<const Reservation*>& reservations) {
+    BinarySnapshotWriter out(file);
+    out.writeHeader(1);
+    out.beginTable("reservations", static_cast<uint32_t>(reservations.size()), 10);
+    out.stringColumn("reservationId", [&](uint32_t i) -> const string& { return reservations[i]->reservationId; });
+    out.stringColumn("customerId", [&](uint32_t i) -> const string& { return reservations[i]->customerId.str(); });
+    out.stringColumn("roomId", [&](uint32_t i) -> const string& { return reservations[i]->roomId.str(); });
+    out.int32Column("checkInDay", [&](uint32_t i) { return civilFromDays(reservations[i]->checkIn).day; });
+    out.int32Column("checkInMonth", [&](uint32_t i) { return civilFromDays(reservations[i]->checkIn).month; });
+    out.int32Column("checkInYear", [&](uint32_t i) { return civilFromDays(reservations[i]->checkIn).year; });
+    out.int32Column("checkOutDay", [&](uint32_t i) { return civilFromDays(reservations[i]->checkOut).day; });
+    out.int32Column("checkOutMonth", [&](uint32_t i) { return civilFromDays(reservations[i]->checkOut).month; });
+    out.int32Column("checkOutYear", [&](uint32_t i) { return civilFromDays(reservations[i]->checkOut).year; });
+    out.stringColumn("status", [&](uint32_t i) -> const string& { return reservationStatusName(reservations[i]->status); });
+    return out.good();
 }
 
 void ReservationManager::saveToFile() {
-    ofstream file(RESERVATION_FILE);
-    if (!file.is_open()) {
+    if (snapshotWriter) snapshotWriter->waitFor(oplog);
+    for (int i = 0; i < count; i++) reservations[i].jsonCache.invalidate();
+    ++version;
+
+    const vector<const Reservation*> list = liveReservations();
+    const bool binary = storageFormat == StorageFormat::Binary;
+    bool ok = SnapshotWriter::writeAtomically(checkpointPath(), [&list, binary](ostream& file) {
+        return binary ? writeReservationsBinary(file, list) : writeReservations(file, list);
+    }, oplog.getDurability());
+    if (!ok) {
         cout << "Loi: Khong the luu du lieu dat phong!\n";
         return;
     }
-    
-    file << "[\n";
-    for (int i = 0; i < count; i++) {
-        file << reservations[i].toJson();
-        if (i < count - 1) file << ",\n";
-        else file << "\n";
+    oplog.truncate();
+}
+
+string ReservationManager::checkpointPath() const {
+    return storageFormat == StorageFormat::Binary ? binarySnapshotPath(RESERVATION_FILE) : RESERVATION_FILE;
+}
+
+void ReservationManager::setStorageFormat(StorageFormat format) {
+    storageFormat = format;
+}
+
+bool ReservationManager::exportToJson() {
+    const vector<const Reservation*> list = liveReservations();
+    return SnapshotWriter::writeAtomically(RESERVATION_FILE, [&list](ostream& file) {
+        return writeReservations(file, list);
+    });
+}
+
+bool ReservationManager::loadFromBinary(const string& path) {
+    using Reader = BinarySnapshotReader;
+    Reader reader;
+    if (!reader.open(path)) return false;
+    const Reader::Table* t = reader.table("reservations");
+    if (!t) return false;
+    const Reader::Column* reservationIdCol = t->column("reservationId", BinarySnapshotWriter::TYPE_STRING);
+    const Reader::Column* customerIdCol = t->column("customerId", BinarySnapshotWriter::TYPE_STRING);
+    const Reader::Column* roomIdCol = t->column("roomId", BinarySnapshotWriter::TYPE_STRING);
+    const Reader::Column* checkInDayCol = t->column("checkInDay", BinarySnapshotWriter::TYPE_INT32);
+    const Reader::Column* checkInMonthCol = t->column("checkInMonth", BinarySnapshotWriter::TYPE_INT32);
+    const Reader::Column* checkInYearCol = t->column("checkInYear", BinarySnapshotWriter::TYPE_INT32);
+    const Reader::Column* checkOutDayCol = t->column("checkOutDay", BinarySnapshotWriter::TYPE_INT32);
+    const Reader::Column* checkOutMonthCol = t->column("checkOutMonth", BinarySnapshotWriter::TYPE_INT32);
+    const Reader::Column* checkOutYearCol = t->column("checkOutYear", BinarySnapshotWriter::TYPE_INT32);
+    const Reader::Column* statusCol = t->column("status", BinarySnapshotWriter::TYPE_STRING);
+    if (!reservationIdCol || !customerIdCol || !roomIdCol || !checkInDayCol ||
+        !checkInMonthCol || !checkInYearCol || !checkOutDayCol || !checkOutMonthCol ||
+        !checkOutYearCol || !statusCol) {
+        return false;
     }
-    file << "]\n";
-    
-    file.close();
+
+    while (capacity < count + static_cast<int>(t->rows)) resize();
+    reservationIndex.reserve(count + t->rows);
+    for (uint32_t row = 0; row < t->rows; row++) {
+        Reservation& rec = reservations[count];
+        rec.reservationId = Reader::stringAt(*reservationIdCol, row);
+        rec.customerId = Reader::stringAt(*customerIdCol, row);
+        rec.roomId = Reader::stringAt(*roomIdCol, row);
+        const int inY = Reader::int32At(*checkInYearCol, row), inM = Reader::int32At(*checkInMonthCol, row),
+                  inD = Reader::int32At(*checkInDayCol, row);
+        const int outY = Reader::int32At(*checkOutYearCol, row), outM = Reader::int32At(*checkOutMonthCol, row),
+                  outD = Reader::int32At(*checkOutDayCol, row);
+        if (!isValidCivil(inY, inM, inD) || !isValidCivil(outY, outM, outD)) {
+            cerr << "Skipping reservation with invalid dates: " << rec.reservationId << "\n";
+            rec = Reservation();
+            continue;
+        }
+        rec.checkIn = daysFromCivil(inY, inM, inD);
+        rec.checkOut = daysFromCivil(outY, outM, outD);
+        if (!parseReservationStatus(Reader::stringAt(*statusCol, row), rec.status)) {
+            cerr << "Skipping reservation with unknown status: " << rec.reservationId << "\n";
+            rec = Reservation();
+            continue;
+        }
+        reservationIndex[rec.reservationId] = count;
+        trackActive(count);
+        count++;
+    }
+    return true;
+}
+
+bool ReservationManager::checkpointInBackground() {
+    if (!snapshotWriter) return false;
+
+    auto image = make_shared<vector<Reservation>>();
+    image->reserve(count - deleted.count());
+    forEachReservation([&image](const Reservation& r) { image->push_back(r); });
+
+    const bool binary = storageFormat == StorageFormat::Binary;
+    return snapshotWriter->scheduleCheckpoint(oplog, checkpointPath(), [image, binary](ostream& file) {
+        vector<const Reservation*> list;
+        list.reserve(image->size());
+        for (const Reservation& r : *image) list.push_back(&r);
+        return binary ? writeReservationsBinary(file, list) : writeReservations(file, list);
+    });
+}
+
+void ReservationManager::setSnapshotWriter(SnapshotWriter* writer) {
+    snapshotWriter = writer;
+}
+
+void ReservationManager::maybeCheckpoint() {
+    // A checkpoint now could capture changes a transaction may still roll back.
+    if (oplog.isStaging() || deferCheckpoints) return;
+    runDueCheckpoint();
+}
+
+void ReservationManager::setDeferredCheckpoints(bool deferred) {
+    deferCheckpoints = deferred;
+}
+
+bool ReservationManager::checkpointDue() const {
+    return oplog.getRecordCount() >= OperationLog::CHECKPOINT_INTERVAL;
+}
+
+void ReservationManager::runDueCheckpoint() {
+    if (!checkpointDue()) return;
+    if (snapshotWriter) checkpointInBackground();
+    else saveToFile();
+}
+
+void ReservationManager::logPut(Reservation& reservation) {
+    reservation.jsonCache.invalidate();
+    reservation.revision = ++version;
+    oplog.appendPut(reservation.reservationId, reservation.toJson());
+    maybeCheckpoint();
+}
+
+void ReservationManager::logDelete(const string& resId) {
+    ++version;
+    oplog.appendDelete(resId);
+    maybeCheckpoint();
+}
+
+void ReservationManager::applyLogRecord(OperationLog::Op op, const string& payload) {
+    if (op == OperationLog::Op::Delete) {
+        auto it = reservationIndex.find(payload);
+        if (it == reservationIndex.end()) return;
+        removeAt(it->second);
+        compactIfDue();
+        return;
+    }
+
+    Reservation parsed;
+    JsonReader reader(payload);
+    if (!reader.nextObject() || !readReservation(reader, parsed)) {
+        cerr << "Skipping invalid reservation log record\n";
+        return;
+    }
+    if (parsed.reservationId.empty()) return;
+    parsed.revision = ++version;
+
+    auto it = reservationIndex.find(parsed.reservationId);
+    if (it != reservationIndex.end()) {
+        untrackActive(it->second);
+        reservations[it->second] = parsed;
+        trackActive(it->second);
+        return;
+    }
+    if (count == capacity) resize();
+    reservations[count] = parsed;
+    reservationIndex[parsed.reservationId] = count;
+    trackActive(count);
+    count++;
 }
 
 bool ReservationManager::makeReservation(string resId, string custId, string roomId, 
-                    int inD, int inM, int inY, int outD, int outM, int outY,
-                    CustomerManager& custMgr, RoomManager& roomMgr, string status) {
+                    DayNumber checkIn, DayNumber checkOut,
+                    CustomerManager& custMgr, RoomManager& roomMgr, ReservationStatus status) {
     if (!custMgr.findCustomer(custId)) {
         cout << "Loi: Khach hang khong ton tai!\n";
         return false;
@@ -61,7 +346,7 @@ bool ReservationManager::makeReservation(string resId, string custId, string roo
         return false;
     }
     
-    if (!room->isAvailable && status == "pending") {
+    if (!room->isAvailable && status == ReservationStatus::Pending) {
         cout << "Loi: Phong da duoc thue!\n";
         return false;
     }
@@ -71,21 +356,18 @@ bool ReservationManager::makeReservation(string resId, string custId, string roo
     reservations[count].reservationId = resId;
     reservations[count].customerId = custId;
     reservations[count].roomId = roomId;
-    reservations[count].checkInDay = inD;
-    reservations[count].checkInMonth = inM;
-    reservations[count].checkInYear = inY;
-    reservations[count].checkOutDay = outD;
-    reservations[count].checkOutMonth = outM;
-    reservations[count].checkOutYear = outY;
+    reservations[count].checkIn = checkIn;
+    reservations[count].checkOut = checkOut;
     reservations[count].status = status;
     reservationIndex[reservations[count].reservationId] = count;
+    trackActive(count);
     count++;
     
     cout << "Dat phong thanh cong!\n";
-    saveToFile();
+    logPut(reservations[count - 1]);
 
     // Keep rooms.json consistent: if a reservation is pending/checkedIn, the room is not available.
-    if (status == "pending" || status == "checkedIn") {
+    if (isActiveStatus(status)) {
         roomMgr.updateRoomStatus(roomId, false);
     }
     return true;
@@ -98,14 +380,14 @@ bool ReservationManager::checkInByReservationId(const string& resId, RoomManager
         return false;
     }
 
-    if (reservation->status != "pending") {
+    if (!canTransition(reservation->status, ReservationStatus::CheckedIn)) {
         cout << "Loi: Chi co the nhan phong o trang thai cho nhan!\n";
         return false;
     }
 
-    reservation->status = "checkedIn";
-    roomMgr.updateRoomStatus(reservation->roomId, false);
-    saveToFile();
+    setStatus(static_cast<int>(reservation - reservations), ReservationStatus::CheckedIn);
+    roomMgr.updateRoomStatus(reservation->roomId.str(), false);
+    logPut(*reservation);
     cout << "Nhan phong thanh cong!\n";
     return true;
 }
@@ -117,25 +399,31 @@ bool ReservationManager::cancelReservation(const string& resId, RoomManager& roo
         return false;
     }
 
-    if (reservation->status != "pending") {
+    if (!canTransition(reservation->status, ReservationStatus::Cancelled)) {
         cout << "Loi: Chi co the huy dat phong o trang thai cho nhan!\n";
         return false;
     }
 
-    reservation->status = "cancel";
-    roomMgr.updateRoomStatus(reservation->roomId, true);
-    saveToFile();
+    setStatus(static_cast<int>(reservation - reservations), ReservationStatus::Cancelled);
+    roomMgr.updateRoomStatus(reservation->roomId.str(), true);
+    logPut(*reservation);
     cout << "Huy phong thanh cong!\n";
     return true;
 }
 
-bool ReservationManager::updateStatus(const string& resId, const string& newStatus) {
+bool ReservationManager::updateStatus(const string& resId, ReservationStatus newStatus) {
     Reservation* reservation = findReservationById(resId);
     if (!reservation) {
         return false;
     }
-    reservation->status = newStatus;
-    saveToFile();
+    if (reservation->status == newStatus) return true;
+    if (!canTransition(reservation->status, newStatus)) {
+        cout << "Loi: Khong the chuyen trang thai dat phong tu " << reservationStatusName(reservation->status)
+             << " sang " << reservationStatusName(newStatus) << "!\n";
+        return false;
+    }
+    setStatus(static_cast<int>(reservation - reservations), newStatus);
+    logPut(*reservation);
     return true;
 }
 
@@ -146,12 +434,14 @@ bool ReservationManager::checkIn(string roomId, RoomManager& roomMgr) {
         return false;
     }
     
-    for (int i = 0; i < count; i++) {
-        if (reservations[i].roomId == roomId && reservations[i].status == "pending") {
-            reservations[i].status = "checkedIn";
+    if (room->roomId.index() < activeByRoom.size()) {
+        for (int slot : activeByRoom[room->roomId.index()]) {
+            if (reservations[slot].status != ReservationStatus::Pending) continue;
+            // setStatus() edits this list; the loop ends right after.
+            setStatus(slot, ReservationStatus::CheckedIn);
             roomMgr.updateRoomStatus(roomId, false);
             cout << "Nhan phong thanh cong!\n";
-            saveToFile();
+            logPut(reservations[slot]);
             return true;
         }
     }
@@ -167,26 +457,39 @@ bool ReservationManager::cancelReservation(const string& resId) {
         return false;
     }
     
-    if (reservation->status != "pending") {
+    if (!canTransition(reservation->status, ReservationStatus::Cancelled)) {
         cout << "Loi: Chi co the huy dat phong o trang thai cho nhan!\n";
         return false;
     }
     
-    reservation->status = "cancel";
-    saveToFile();
+    setStatus(static_cast<int>(reservation - reservations), ReservationStatus::Cancelled);
+    logPut(*reservation);
     cout << "Huy phong thanh cong!\n";
     return true;
 }
 
 Reservation* ReservationManager::findReservationByRoom(string roomId) {
-    for (int i = 0; i < count; i++) {
-        if (reservations[i].roomId == roomId && reservations[i].status == "checkedIn") {
-            return &reservations[i];
-        }
+    RoomKey key;
+    if (!RoomKey::find(roomId, key) || key.index() >= activeByRoom.size()) return nullptr;
+    for (int slot : activeByRoom[key.index()]) {
+        if (reservations[slot].status == ReservationStatus::CheckedIn) return &reservations[slot];
     }
     return nullptr;
 }
 
+const Reservation* ReservationManager::findActiveReservation(RoomKey room) const {
+    if (room.index() >= activeByRoom.size()) return nullptr;
+    const SmallVector<int, 2>& slots = activeByRoom[room.index()];
+    for (int slot : slots) {
+        if (reservations[slot].status == ReservationStatus::CheckedIn) return &reservations[slot];
+    }
+    return slots.empty() ? nullptr : &reservations[slots[0]];
+}
+
+bool ReservationManager::hasActiveReservation(RoomKey room) const {
+    return room.index() < activeByRoom.size() && !activeByRoom[room.index()].empty();
+}
+
 Reservation* ReservationManager::findReservationById(const string& resId) {
     auto it = reservationIndex.find(resId);
     if (it == reservationIndex.end()) return nullptr;
@@ -195,64 +498,80 @@ Reservation* ReservationManager::findReservationById(const string& resId) {
     return &reservations[idx];
 }
 
-void ReservationManager::loadFromJson(const string& json) {
-    size_t pos = 1;
-    while (pos < json.length()) {
-        size_t start = json.find("{", pos);
-        if (start == string::npos) break;
-        
-        size_t end = json.find("}", start);
-        if (end == string::npos) break;
-        
-        string obj = json.substr(start, end - start + 1);
-        
-        if (count == capacity) resize();
-        
-        reservations[count].reservationId = JsonHelper::extractValue(obj, "reservationId");
-        reservations[count].customerId = JsonHelper::extractValue(obj, "customerId");
-        reservations[count].roomId = JsonHelper::extractValue(obj, "roomId");
-        reservations[count].checkInDay = stoi(JsonHelper::extractValue(obj, "checkInDay"));
-        reservations[count].checkInMonth = stoi(JsonHelper::extractValue(obj, "checkInMonth"));
-        reservations[count].checkInYear = stoi(JsonHelper::extractValue(obj, "checkInYear"));
-        reservations[count].checkOutDay = stoi(JsonHelper::extractValue(obj, "checkOutDay"));
-        reservations[count].checkOutMonth = stoi(JsonHelper::extractValue(obj, "checkOutMonth"));
-        reservations[count].checkOutYear = stoi(JsonHelper::extractValue(obj, "checkOutYear"));
-        
-        // Try to load status (new format), fallback to isCheckedIn (old format)
-        string statusStr = JsonHelper::extractValue(obj, "status");
-        if (!statusStr.empty()) {
-            reservations[count].status = statusStr;
-        } else {
-            string checkedIn = JsonHelper::extractValue(obj, "isCheckedIn");
-            reservations[count].status = (checkedIn == "true") ? "checkedIn" : "pending";
+// Parses one chunk of reservations.json; malformed records are skipped.
+static void parseReservationChunk(std::string_view chunk, vector<Reservation>& out) {
+    JsonReader reader(chunk);
+    while (reader.nextObject()) {
+        Reservation r;
+        if (!readReservation(reader, r)) {
+            cerr << "Skipping invalid reservation record\n";
+            if (reader.failed()) break;
+            continue;
         }
-        
-        reservationIndex[reservations[count].reservationId] = count;
-        count++;
-        pos = end + 1;
+        out.push_back(std::move(r));
     }
 }
 
-void ReservationManager::loadFromFile() {
-    ifstream file(RESERVATION_FILE);
-    if (!file.is_open()) {
-        return;
+void ReservationManager::loadFromJson(const string& json, ThreadPool* pool) {
+    vector<vector<Reservation>> parts = parseJsonArrayChunks<Reservation>(json, pool, parseReservationChunk);
+
+    size_t total = 0;
+    for (const auto& part : parts) total += part.size();
+    while (capacity < count + static_cast<int>(total)) resize();
+    reservationIndex.reserve(count + total);
+
+    for (auto& part : parts) {
+        for (Reservation& r : part) {
+            reservations[count] = std::move(r);
+            reservationIndex[reservations[count].reservationId] = count;
+            trackActive(count);
+            count++;
+        }
     }
-    
-    stringstream buffer;
-    buffer << file.rdbuf();
-    string json = buffer.str();
-    file.close();
-    
-    loadFromJson(json);
+}
+
+void ReservationManager::loadFromFile(ThreadPool* pool) {
+    ifstream file;
+    if (!binarySnapshotIsCurrent(RESERVATION_FILE) || !loadFromBinary(binarySnapshotPath(RESERVATION_FILE))) {
+        file.open(RESERVATION_FILE);
+    }
+    const bool importedJson = file.is_open();
+    if (importedJson) {
+        stringstream buffer;
+        buffer << file.rdbuf();
+        string json = buffer.str();
+        file.close();
+
+        loadFromJson(json, pool);
+    }
+
+    oplog.replay([this](OperationLog::Op op, const string& payload) {
+        applyLogRecord(op, payload);
+    });
+
+    // First start in binary mode: convert the imported JSON right away.
+    if (importedJson && storageFormat == StorageFormat::Binary) saveToFile();
 }
 
 int ReservationManager::getReservationCount() {
-    return count;
+    return count - deleted.count();
+}
+
+OperationLog& ReservationManager::getOperationLog() {
+    return oplog;
+}
+
+std::shared_mutex& ReservationManager::getMutex() const {
+    return storeMutex;
 }
 
-Reservation* ReservationManager::getReservations() {
-    return reservations;
+uint64_t ReservationManager::getVersion() const {
+    return version.load();
+}
+
+void ReservationManager::restoreRecord(OperationLog::Op op, const string& payload) {
+    applyLogRecord(op, payload);
+    ++version;
 }
 
 bool ReservationManager::deleteReservation(const string& resId, RoomManager& roomMgr) {
@@ -266,33 +585,18 @@ bool ReservationManager::deleteReservation(const string& resId, RoomManager& roo
         return false;
     }
 
-    const std::string roomId = reservations[idx].roomId;
-    const std::string status = reservations[idx].status;
-    const bool wasActive = (status == "pending" || status == "checkedIn");
+    const RoomKey roomId = reservations[idx].roomId;
+    const bool wasActive = isActiveStatus(reservations[idx].status);
 
-    // Remove by shifting.
-    for (int i = idx; i < count - 1; ++i) {
-        reservations[i] = reservations[i + 1];
-    }
-    --count;
-    rebuildIndex();
-    saveToFile();
+    removeAt(idx);
+    logDelete(resId);
+    compactIfDue();
 
     // If we deleted an active reservation, release the room only if no other active
     // reservation exists for that room.
-    if (wasActive) {
-        bool stillActive = false;
-        for (int i = 0; i < count; ++i) {
-            if (reservations[i].roomId == roomId &&
-                (reservations[i].status == "pending" || reservations[i].status == "checkedIn")) {
-                stillActive = true;
-                break;
-            }
-        }
-        if (!stillActive) {
-            // Release room (also clears services + persists)
-            roomMgr.updateRoomStatus(roomId, true);
-        }
+    if (wasActive && !hasActiveReservation(roomId)) {
+        // Release room (also clears services + persists)
+        roomMgr.updateRoomStatus(roomId.str(), true);
     }
 
     return true;
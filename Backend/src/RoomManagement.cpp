@@ -9,94 +9,338 @@
 #include <algorithm>
 #include <chrono>
 #include <cctype>
+#include <memory>
+#include <vector>
 #include "nlohmann/json.hpp"
 using namespace std;
 using json = nlohmann::json;
 
-RoomManager::RoomManager(int cap) : capacity(cap), count(0) {
+RoomManager::RoomManager(int cap)
+    : capacity(cap), count(0), dataFile("rooms.json"), oplog("rooms.json.log"), snapshotWriter(nullptr),
+      storageFormat(StorageFormat::Json), deferCheckpoints(false) {
     rooms = new Room[capacity];
 }
 
 RoomManager::~RoomManager() {
-    for (int i = 0; i < count; i++) {
-        Service* curr = rooms[i].serviceList;
-        while (curr) {
-            Service* temp = curr;
-            curr = curr->next;
-            delete temp;
+    delete[] rooms;
+}
+
+// Builds a room (including its service list) from one parsed JSON object.
+static bool readRoom(const json& item, Room& room) {
+    if (!item.is_object()) return false;
+    string id = item.value("roomId", "");
+    if (id.empty()) return false;
+
+    room = Room(id, item.value("roomType", ""), item.value("pricePerDay", 0.0));
+    room.isAvailable = item.value("isAvailable", true);
+
+    if (item.contains("services") && item["services"].is_array()) {
+        for (const auto& svc : item["services"]) {
+            if (!svc.is_object()) continue;
+            string name = svc.value("serviceName", svc.value("name", ""));
+            double p = svc.value("price", 0.0);
+            int q = svc.value("quantity", 1);
+            room.services.emplace_back(name, p, q);
         }
     }
-    delete[] rooms;
+    return true;
 }
 
 void RoomManager::resize() {
     capacity *= 2;
     Room* newRooms = new Room[capacity];
     for (int i = 0; i < count; i++) {
-        newRooms[i] = rooms[i];
+        newRooms[i] = std::move(rooms[i]);
     }
     delete[] rooms;
     rooms = newRooms;
     rebuildIndex();
 }
 
+static bool writeRooms(ostream& file, const vector<const Room*>& rooms) {
+    return JsonWriter::writeFileArray(file, rooms.size(), [&](size_t i, JsonWriter& w) {
+        rooms[i]->writeJson(w);
+    });
+}
+
+static bool writeRoomsBinary(ostream& file, const vector<const Room*>& rooms) {
+    const uint32_t n = static_cast<uint32_t>(rooms.size());
+    vector<const Service*> services;
+    vector<int32_t> serviceCounts(n, 0);
+    for (uint32_t i = 0; i < n; i++) {
+        for (const Service& s : rooms[i]->services) services.push_back(&s);
+        serviceCounts[i] = static_cast<int32_t>(rooms[i]->services.size());
+    }
+
+    BinarySnapshotWriter out(file);
+    out.writeHeader(2);
+    out.beginTable("rooms", n, 5);
+    out.stringColumn("roomId", [&](uint32_t i) -> const string& { return rooms[i]->roomId.str(); });
+    out.stringColumn("roomType", [&](uint32_t i) -> const string& { return rooms[i]->roomType.str(); });
+    out.float64Column("pricePerDay", [&](uint32_t i) { return rooms[i]->pricePerDay; });
+    out.boolColumn("isAvailable", [&](uint32_t i) { return rooms[i]->isAvailable; });
+    out.int32Column("serviceCount", [&](uint32_t i) { return serviceCounts[i]; });
+
+    out.beginTable("services", static_cast<uint32_t>(services.size()), 3);
+    out.stringColumn("serviceName", [&](uint32_t i) -> const string& { return services[i]->serviceName.str(); });
+    out.float64Column("price", [&](uint32_t i) { return services[i]->price; });
+    out.int32Column("quantity", [&](uint32_t i) { return services[i]->quantity; });
+    return out.good();
+}
+
+// Point-in-time copy of the rooms (services included) owned by the snapshot thread.
+struct RoomImage {
+    vector<Room> rooms;
+};
+
 void RoomManager::saveToFile(string filename) {
-    ofstream file(filename);
-    if (!file.is_open()) {
+    if (filename != dataFile) {
+        // Plain JSON export; the checkpoint and log are untouched.
+        const vector<const Room*> list = liveRooms();
+        bool ok = SnapshotWriter::writeAtomically(filename, [&list](ostream& file) {
+            return writeRooms(file, list);
+        });
+        if (!ok) cout << "Loi: Khong the luu du lieu phong!\n";
+        return;
+    }
+
+    if (snapshotWriter) snapshotWriter->waitFor(oplog);
+    // Whole-store edits (reconcile, merge) checkpoint instead of logging records.
+    for (int i = 0; i < count; i++) rooms[i].jsonCache.invalidate();
+    ++version;
+
+    const vector<const Room*> list = liveRooms();
+    const bool binary = storageFormat == StorageFormat::Binary;
+    bool ok = SnapshotWriter::writeAtomically(checkpointPath(), [&list, binary](ostream& file) {
+        return binary ? writeRoomsBinary(file, list) : writeRooms(file, list);
+    }, oplog.getDurability());
+    if (!ok) {
         cout << "Loi: Khong the luu du lieu phong!\n";
         return;
     }
-    
-    file << "[\n";
-    for (int i = 0; i < count; i++) {
-        file << rooms[i].toJson();
-        if (i < count - 1) file << ",\n";
-        else file << "\n";
+
+    // The checkpoint now contains everything the log described.
+    oplog.truncate();
+}
+
+string RoomManager::checkpointPath() const {
+    return storageFormat == StorageFormat::Binary ? binarySnapshotPath(dataFile) : dataFile;
+}
+
+void RoomManager::setStorageFormat(StorageFormat format) {
+    storageFormat = format;
+}
+
+bool RoomManager::exportToJson() {
+    const vector<const Room*> list = liveRooms();
+    return SnapshotWriter::writeAtomically(dataFile, [&list](ostream& file) {
+        return writeRooms(file, list);
+    });
+}
+
+bool RoomManager::loadFromBinary(const string& path) {
+    using Reader = BinarySnapshotReader;
+    Reader reader;
+    if (!reader.open(path)) return false;
+    const Reader::Table* rt = reader.table("rooms");
+    const Reader::Table* st = reader.table("services");
+    if (!rt || !st) return false;
+    const Reader::Column* id = rt->column("roomId", BinarySnapshotWriter::TYPE_STRING);
+    const Reader::Column* type = rt->column("roomType", BinarySnapshotWriter::TYPE_STRING);
+    const Reader::Column* price = rt->column("pricePerDay", BinarySnapshotWriter::TYPE_FLOAT64);
+    const Reader::Column* avail = rt->column("isAvailable", BinarySnapshotWriter::TYPE_BOOL);
+    const Reader::Column* svcCount = rt->column("serviceCount", BinarySnapshotWriter::TYPE_INT32);
+    const Reader::Column* svcName = st->column("serviceName", BinarySnapshotWriter::TYPE_STRING);
+    const Reader::Column* svcPrice = st->column("price", BinarySnapshotWriter::TYPE_FLOAT64);
+    const Reader::Column* svcQty = st->column("quantity", BinarySnapshotWriter::TYPE_INT32);
+    if (!id || !type || !price || !avail || !svcCount || !svcName || !svcPrice || !svcQty) return false;
+
+    count = 0;
+    deleted.clear();
+    slotByKey.clear();
+    while (capacity < static_cast<int>(rt->rows)) resize();
+
+    uint32_t nextService = 0;
+    for (uint32_t row = 0; row < rt->rows; row++) {
+        Room& room = rooms[count];
+        room = Room(Reader::stringAt(*id, row), Reader::stringAt(*type, row), Reader::float64At(*price, row));
+        room.isAvailable = Reader::boolAt(*avail, row);
+
+        int n = Reader::int32At(*svcCount, row);
+        for (int k = 0; k < n && nextService < st->rows; k++, nextService++) {
+            room.services.emplace_back(Reader::stringAt(*svcName, nextService),
+                                       Reader::float64At(*svcPrice, nextService),
+                                       Reader::int32At(*svcQty, nextService));
+        }
+        setSlot(room.roomId, count);
+        count++;
+    }
+    return true;
+}
+
+bool RoomManager::checkpointInBackground() {
+    if (!snapshotWriter) return false;
+
+    auto image = make_shared<RoomImage>();
+    image->rooms.reserve(count - deleted.count());
+    forEachRoom([&image](const Room& room) { image->rooms.push_back(room); });
+
+    const bool binary = storageFormat == StorageFormat::Binary;
+    return snapshotWriter->scheduleCheckpoint(oplog, checkpointPath(), [image, binary](ostream& file) {
+        vector<const Room*> list;
+        list.reserve(image->rooms.size());
+        for (const Room& room : image->rooms) list.push_back(&room);
+        return binary ? writeRoomsBinary(file, list) : writeRooms(file, list);
+    });
+}
+
+void RoomManager::setSnapshotWriter(SnapshotWriter* writer) {
+    snapshotWriter = writer;
+}
+
+void RoomManager::maybeCheckpoint() {
+    // A checkpoint now could capture changes a transaction may still roll back.
+    if (oplog.isStaging() || deferCheckpoints) return;
+    runDueCheckpoint();
+}
+
+void RoomManager::setDeferredCheckpoints(bool deferred) {
+    deferCheckpoints = deferred;
+}
+
+bool RoomManager::checkpointDue() const {
+    return oplog.getRecordCount() >= OperationLog::CHECKPOINT_INTERVAL;
+}
+
+void RoomManager::runDueCheckpoint() {
+    if (!checkpointDue()) return;
+    if (snapshotWriter) checkpointInBackground();
+    else saveToFile(dataFile);
+}
+
+void RoomManager::logPut(Room& room) {
+    room.jsonCache.invalidate();
+    room.revision = ++version;
+    oplog.appendPut(room.roomId.str(), room.toJson());
+    maybeCheckpoint();
+}
+
+void RoomManager::logDelete(const string& roomId) {
+    ++version;
+    oplog.appendDelete(roomId);
+    maybeCheckpoint();
+}
+
+void RoomManager::persistRoom(const string& roomId) {
+    if (Room* room = findRoom(roomId)) logPut(*room);
+}
+
+void RoomManager::applyLogRecord(OperationLog::Op op, const string& payload) {
+    if (op == OperationLog::Op::Delete) {
+        RoomKey key;
+        if (!RoomKey::find(payload, key) || slotOf(key) < 0) return;
+        removeAt(slotOf(key));
+        compactIfDue();
+        return;
     }
-    file << "]\n";
-    
-    file.close();
+
+    Room room;
+    try {
+        if (!readRoom(json::parse(payload), room)) return;
+    } catch (const std::exception& e) {
+        cerr << "Skipping invalid room log record: " << e.what() << "\n";
+        return;
+    }
+
+    room.revision = ++version;
+    const int slot = slotOf(room.roomId);
+    if (slot >= 0) {
+        rooms[slot] = std::move(room);
+        return;
+    }
+    if (count == capacity) resize();
+    setSlot(room.roomId, count);
+    rooms[count] = std::move(room);
+    count++;
+}
+
+bool RoomManager::isValidRoomType(const string& roomType) {
+    if (roomType.empty() || roomType.size() > MAX_ROOM_TYPE_LENGTH) return false;
+    return SymbolTable::global().fitsBudget(roomType, MAX_ROOM_TYPE_SYMBOLS);
 }
 
 bool RoomManager::addRoom(string id, string type, double price) {
-    if (roomIndex.find(id) != roomIndex.end()) return false;
+    if (!isValidRoomType(type)) {
+        cout << "Loai phong khong hop le!\n";
+        return false;
+    }
+    if (findRoom(id)) return false;
     if (count == capacity) resize();
     rooms[count] = Room(id, type, price);
-    rooms[count].serviceList = nullptr;
     rooms[count].isAvailable = true;
-    roomIndex[id] = count;
+    setSlot(rooms[count].roomId, count);
     count++;
-    saveToFile();
+    logPut(rooms[count - 1]);
     return true;
 }
 
 bool RoomManager::deleteRoom(string id) {
-    auto it = roomIndex.find(id);
-    if (it == roomIndex.end()) return false;
-    int idx = it->second;
-    Service* curr = rooms[idx].serviceList;
-    while (curr) {
-        Service* tmp = curr;
-        curr = curr->next;
-        delete tmp;
-    }
-    for (int i = idx; i < count - 1; i++) {
-        rooms[i] = rooms[i+1];
-    }
-    count--;
-    rebuildIndex();
-    saveToFile();
+    Room* room = findRoom(id);
+    if (!room) return false;
+    removeAt(static_cast<int>(room - rooms));
+    logDelete(id);
+    compactIfDue();
     return true;
 }
 
+// O(1): the slot becomes a tombstone and only this id leaves the index.
+void RoomManager::removeAt(int slot) {
+    setSlot(rooms[slot].roomId, -1);
+    rooms[slot] = Room();
+    deleted.mark(slot);
+}
+
+// Runs only from delete paths, which hold the store exclusively: moving rooms
+// would invalidate Room* that a shared-lock caller still holds.
+void RoomManager::compactIfDue() {
+    if (!deleted.compactionDue(count)) return;
+    count = deleted.compact(rooms, count);
+    rebuildIndex();
+}
+
+vector<const Room*> RoomManager::liveRooms() const {
+    vector<const Room*> list;
+    list.reserve(count - deleted.count());
+    for (int i = 0; i < count; i++) {
+        if (!deleted.isDead(i)) list.push_back(&rooms[i]);
+    }
+    return list;
+}
+
 Room* RoomManager::findRoom(string id) {
-    auto it = roomIndex.find(id);
-    if (it == roomIndex.end()) return nullptr;
-    int idx = it->second;
+    RoomKey key;
+    if (!RoomKey::find(id, key)) return nullptr;
+    return findRoom(key);
+}
+
+Room* RoomManager::findRoom(RoomKey key) {
+    const int idx = slotOf(key);
     if (idx < 0 || idx >= count) return nullptr;
     return &rooms[idx];
 }
 
+int RoomManager::slotOf(RoomKey key) const {
+    return key.index() < slotByKey.size() ? slotByKey[key.index()] : -1;
+}
+
+void RoomManager::setSlot(RoomKey key, int slot) {
+    if (key.index() >= slotByKey.size()) {
+        if (slot < 0) return;
+        slotByKey.resize(RoomIds::dictionary().size(), -1);
+    }
+    slotByKey[key.index()] = slot;
+}
+
 void RoomManager::updateRoomStatus(string roomId, bool available) {
     Room* room = findRoom(roomId);
     if (room) {
@@ -105,67 +349,48 @@ void RoomManager::updateRoomStatus(string roomId, bool available) {
             ServiceManagement::clearServices(*this, roomId, false);
         }
         room->isAvailable = available;
-        saveToFile();
+        logPut(*room);
     }
 }
 
 int RoomManager::getRoomCount() { 
-    return count; 
+    return count - deleted.count(); 
+}
+
+OperationLog& RoomManager::getOperationLog() {
+    return oplog;
 }
 
-Room* RoomManager::getRooms() { 
-    return rooms; 
+std::shared_mutex& RoomManager::getMutex() const {
+    return storeMutex;
+}
+
+uint64_t RoomManager::getVersion() const {
+    return version.load();
+}
+
+void RoomManager::restoreRecord(OperationLog::Op op, const string& payload) {
+    applyLogRecord(op, payload);
+    ++version;
 }
 
 void RoomManager::loadFromJson(const string& jsonStr) {
-    // Clear existing data to avoid duplicates and leaks
+    // Clear existing data to avoid duplicates
     for (int i = 0; i < count; i++) {
-        Service* curr = rooms[i].serviceList;
-        while (curr) {
-            Service* tmp = curr;
-            curr = curr->next;
-            delete tmp;
-        }
+        rooms[i] = Room();
     }
     count = 0;
-    roomIndex.clear();
+    deleted.clear();
+    slotByKey.clear();
 
     try {
         auto arr = json::parse(jsonStr);
         if (!arr.is_array()) return;
 
         for (const auto& item : arr) {
-            if (!item.is_object()) continue;
-            string id = item.value("roomId", "");
-            string type = item.value("roomType", "");
-            double price = item.value("pricePerDay", 0.0);
-            bool available = item.value("isAvailable", true);
-            if (id.empty()) continue;
-
             if (count == capacity) resize();
-            rooms[count] = Room(id, type, price);
-            rooms[count].isAvailable = available;
-            rooms[count].serviceList = nullptr;
-
-            Service* tail = nullptr;
-            if (item.contains("services") && item["services"].is_array()) {
-                for (const auto& svc : item["services"]) {
-                    if (!svc.is_object()) continue;
-                    string name = svc.value("serviceName", svc.value("name", ""));
-                    double p = svc.value("price", 0.0);
-                    int q = svc.value("quantity", 1);
-                    Service* node = new Service(name, p, q);
-                    if (!rooms[count].serviceList) {
-                        rooms[count].serviceList = node;
-                        tail = node;
-                    } else {
-                        tail->next = node;
-                        tail = node;
-                    }
-                }
-            }
-
-            roomIndex[id] = count;
+            if (!readRoom(item, rooms[count])) continue;
+            setSlot(rooms[count].roomId, count);
             count++;
         }
     } catch (const std::exception& e) {
@@ -174,34 +399,51 @@ void RoomManager::loadFromJson(const string& jsonStr) {
 }
 
 void RoomManager::loadFromFile(string filename) {
-    ifstream file(filename);
-    if (!file.is_open()) {
-        return;
+    dataFile = filename;
+    oplog.setPath(filename + ".log");
+
+    ifstream file;
+    if (!binarySnapshotIsCurrent(filename) || !loadFromBinary(binarySnapshotPath(filename))) {
+        file.open(filename);
+    }
+    const bool importedJson = file.is_open();
+    if (importedJson) {
+        stringstream buffer;
+        buffer << file.rdbuf();
+        string json = buffer.str();
+        file.close();
+
+        loadFromJson(json);
     }
-    
-    stringstream buffer;
-    buffer << file.rdbuf();
-    string json = buffer.str();
-    file.close();
-    
-    loadFromJson(json);
+
+    oplog.replay([this](OperationLog::Op op, const string& payload) {
+        applyLogRecord(op, payload);
+    });
+
+    // First start in binary mode: convert the imported JSON right away.
+    if (importedJson && storageFormat == StorageFormat::Binary) saveToFile(dataFile);
 }
 
 void RoomManager::sortRoomsByPrice(bool ascending) {
+    if (deleted.count() > 0) {
+        count = deleted.compact(rooms, count);
+        rebuildIndex();
+    }
     if (count <= 1) return;
     auto start = chrono::high_resolution_clock::now();
     if (ascending) {
         std::sort(rooms, rooms + count, [](const Room& a, const Room& b) {
             if (a.pricePerDay != b.pricePerDay) return a.pricePerDay < b.pricePerDay;
-            return a.roomId < b.roomId;
+            return a.roomId.str() < b.roomId.str();
         });
     } else {
         std::sort(rooms, rooms + count, [](const Room& a, const Room& b) {
             if (a.pricePerDay != b.pricePerDay) return a.pricePerDay > b.pricePerDay;
-            return a.roomId < b.roomId;
+            return a.roomId.str() < b.roomId.str();
         });
     }
     rebuildIndex();
+    ++version;
     auto end = chrono::high_resolution_clock::now();
     chrono::duration<double, milli> elapsed = end - start;
     double elapsedMs = elapsed.count();
@@ -214,8 +456,8 @@ void RoomManager::sortRoomsByPrice(bool ascending) {
          << setw(15) << "Trang thai" << endl;
     cout << string(52, '-') << endl;
     for (int i = 0; i < count; i++) {
-        cout << left << setw(10) << rooms[i].roomId
-             << setw(12) << rooms[i].roomType
+        cout << left << setw(10) << rooms[i].roomId.str()
+             << setw(12) << rooms[i].roomType.str()
              << setw(15) << fixed << setprecision(3) << rooms[i].pricePerDay
              << setw(15) << (rooms[i].isAvailable ? "Trong" : "Dang thue") << endl;
     }
@@ -223,8 +465,8 @@ void RoomManager::sortRoomsByPrice(bool ascending) {
 }
 
 void RoomManager::rebuildIndex() {
-    roomIndex.clear();
+    slotByKey.assign(RoomIds::dictionary().size(), -1);
     for (int i = 0; i < count; ++i) {
-        roomIndex[rooms[i].roomId] = i;
+        if (!deleted.isDead(i)) slotByKey[rooms[i].roomId.index()] = i;
     }
 }
\ No newline at end of file
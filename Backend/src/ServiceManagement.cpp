@@ -2,11 +2,14 @@
 
 #include "RoomManagement.h"
 
-#include <algorithm>
-#include <cctype>
 #include <iostream>
 #include <unordered_map>
 
+bool ServiceManagement::isValidServiceName(const std::string& serviceName) {
+    if (serviceName.empty() || serviceName.size() > MAX_SERVICE_NAME_LENGTH) return false;
+    return SymbolTable::global().fitsBudget(serviceName, MAX_NAME_SYMBOLS);
+}
+
 bool ServiceManagement::addServiceToRoom(RoomManager& roomMgr,
                                         const std::string& roomId,
                                         const std::string& serviceName,
@@ -23,32 +26,29 @@ bool ServiceManagement::addServiceToRoom(RoomManager& roomMgr,
         return false;
     }
 
-    auto normalize = [](const std::string& s) {
-        std::string out = s;
-        std::transform(out.begin(), out.end(), out.begin(), [](unsigned char c) {
-            return static_cast<char>(std::tolower(c));
-        });
-        return out;
-    };
+    if (!isValidServiceName(serviceName)) {
+        std::cout << "Ten dich vu khong hop le!\n";
+        return false;
+    }
 
-    const std::string key = normalize(serviceName);
+    // Names match case-insensitively: compare the folded symbols.
+    const Interned name(serviceName);
+    const SymbolTable::Symbol key = name.folded();
 
-    for (Service* curr = room->serviceList; curr; curr = curr->next) {
-        if (normalize(curr->serviceName) == key) {
-            curr->price = price;
-            curr->quantity += quantity;
+    for (Service& svc : room->services) {
+        if (svc.serviceName.folded() == key) {
+            svc.price = price;
+            svc.quantity += quantity;
             std::cout << "Cap nhat dich vu thanh cong!\n";
-            roomMgr.saveToFile();
+            roomMgr.persistRoom(roomId);
             return true;
         }
     }
 
-    Service* newService = new Service(serviceName, price, quantity);
-    newService->next = room->serviceList;
-    room->serviceList = newService;
+    room->services.insert(0, Service(name, price, quantity));
 
     std::cout << "Them dich vu thanh cong!\n";
-    roomMgr.saveToFile();
+    roomMgr.persistRoom(roomId);
     return true;
 }
 
@@ -56,23 +56,10 @@ bool ServiceManagement::removeServiceByIndex(RoomManager& roomMgr,
                                             const std::string& roomId,
                                             int index) {
     Room* room = roomMgr.findRoom(roomId);
-    if (!room || index < 0) return false;
-
-    Service* prev = nullptr;
-    Service* curr = room->serviceList;
-    int i = 0;
-    while (curr && i < index) {
-        prev = curr;
-        curr = curr->next;
-        ++i;
-    }
-    if (!curr) return false;
-
-    if (prev) prev->next = curr->next;
-    else room->serviceList = curr->next;
+    if (!room || index < 0 || static_cast<size_t>(index) >= room->services.size()) return false;
 
-    delete curr;
-    roomMgr.saveToFile();
+    room->services.erase(static_cast<size_t>(index));
+    roomMgr.persistRoom(roomId);
     return true;
 }
 
@@ -80,14 +67,7 @@ int ServiceManagement::getServiceCount(RoomManager& roomMgr,
                                       const std::string& roomId) {
     Room* room = roomMgr.findRoom(roomId);
     if (!room) return 0;
-
-    int countSvc = 0;
-    Service* curr = room->serviceList;
-    while (curr) {
-        ++countSvc;
-        curr = curr->next;
-    }
-    return countSvc;
+    return static_cast<int>(room->services.size());
 }
 
 double ServiceManagement::calculateServiceCharge(RoomManager& roomMgr,
@@ -95,12 +75,12 @@ double ServiceManagement::calculateServiceCharge(RoomManager& roomMgr,
     Room* room = roomMgr.findRoom(roomId);
     if (!room) return 0;
 
+    return calculateServiceCharge(*room);
+}
+
+double ServiceManagement::calculateServiceCharge(const Room& room) {
     double total = 0;
-    Service* curr = room->serviceList;
-    while (curr) {
-        total += curr->price * curr->quantity;
-        curr = curr->next;
-    }
+    for (const Service& svc : room.services) total += svc.price * svc.quantity;
     return total;
 }
 
@@ -110,70 +90,45 @@ void ServiceManagement::clearServices(RoomManager& roomMgr,
     Room* room = roomMgr.findRoom(roomId);
     if (!room) return;
 
-    Service* curr = room->serviceList;
-    while (curr) {
-        Service* temp = curr;
-        curr = curr->next;
-        delete temp;
-    }
-    room->serviceList = nullptr;
+    room->services.clear();
 
     if (persist) {
-        roomMgr.saveToFile();
+        roomMgr.persistRoom(roomId);
     }
 }
 
 int ServiceManagement::mergeDuplicateServices(RoomManager& roomMgr, bool persist) {
-    Room* rooms = roomMgr.getRooms();
-    const int roomCount = roomMgr.getRoomCount();
-    if (!rooms || roomCount <= 0) return 0;
-
-    auto normalize = [](const std::string& s) {
-        std::string out = s;
-        std::transform(out.begin(), out.end(), out.begin(), [](unsigned char c) {
-            return static_cast<char>(std::tolower(c));
-        });
-        return out;
-    };
+    if (roomMgr.getRoomCount() <= 0) return 0;
 
     int duplicatesRemoved = 0;
     bool anyChanged = false;
 
-    for (int r = 0; r < roomCount; ++r) {
-        Room& room = rooms[r];
-        if (!room.serviceList) continue;
+    roomMgr.forEachRoom([&](Room& room) {
+        if (room.services.size() < 2) return;
 
-        std::unordered_map<std::string, Service*> seen;
+        // Maps each folded name to the slot of its first occurrence.
+        std::unordered_map<SymbolTable::Symbol, size_t> seen;
 
-        Service* prev = nullptr;
-        Service* curr = room.serviceList;
-        while (curr) {
-            const std::string key = normalize(curr->serviceName);
+        size_t kept = 0;
+        for (size_t i = 0; i < room.services.size(); ++i) {
+            Service& svc = room.services[i];
+            const SymbolTable::Symbol key = svc.serviceName.folded();
             auto it = seen.find(key);
             if (it == seen.end()) {
-                seen.emplace(key, curr);
-                prev = curr;
-                curr = curr->next;
+                seen.emplace(key, kept);
+                if (kept != i) room.services[kept] = std::move(svc);
+                ++kept;
                 continue;
             }
 
             // Merge into first occurrence.
-            it->second->quantity += curr->quantity;
+            room.services[it->second].quantity += svc.quantity;
             // Keep the first price to match legacy script behavior.
-
-            Service* toDelete = curr;
-            if (prev) {
-                prev->next = curr->next;
-                curr = prev->next;
-            } else {
-                room.serviceList = curr->next;
-                curr = room.serviceList;
-            }
-            delete toDelete;
             ++duplicatesRemoved;
             anyChanged = true;
         }
-    }
+        while (room.services.size() > kept) room.services.erase(room.services.size() - 1);
+    });
 
     if (persist && anyChanged) {
         roomMgr.saveToFile();
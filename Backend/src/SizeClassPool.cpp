@@ -0,0 +1,75 @@
+#include "SizeClassPool.h"
+
+#include <new>
+
+SizeClassPool::SizeClassPool() : bump(nullptr), bumpLeft(0) {
+    for (FreeBlock*& head : freeLists) head = nullptr;
+}
+
+SizeClassPool::~SizeClassPool() {
+    for (char* chunk : chunks) ::operator delete(chunk);
+}
+
+std::size_t SizeClassPool::classOf(std::size_t bytes) {
+    std::size_t cls = 0;
+    std::size_t size = 16;
+    while (size < bytes) {
+        size <<= 1;
+        ++cls;
+    }
+    return cls;
+}
+
+void* SizeClassPool::allocate(std::size_t bytes) {
+    if (bytes > MAX_CLASS_SIZE) {
+        std::lock_guard<std::mutex> lock(mtx);
+        ++stats.allocations;
+        ++stats.largeAllocations;
+        return ::operator new(bytes);
+    }
+
+    const std::size_t cls = classOf(bytes);
+    const std::size_t size = std::size_t(16) << cls;
+    std::lock_guard<std::mutex> lock(mtx);
+    ++stats.allocations;
+    if (FreeBlock* block = freeLists[cls]) {
+        freeLists[cls] = block->next;
+        ++stats.reused;
+        return block;
+    }
+    if (bumpLeft < size) {
+        // The tail of the old chunk is too small for this class; it stays unused.
+        bump = static_cast<char*>(::operator new(CHUNK_SIZE));
+        bumpLeft = CHUNK_SIZE;
+        chunks.push_back(bump);
+        ++stats.chunks;
+    }
+    void* p = bump;
+    bump += size;
+    bumpLeft -= size;
+    return p;
+}
+
+void SizeClassPool::deallocate(void* p, std::size_t bytes) {
+    if (!p) return;
+    if (bytes > MAX_CLASS_SIZE) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            ++stats.frees;
+        }
+        ::operator delete(p);
+        return;
+    }
+
+    const std::size_t cls = classOf(bytes);
+    std::lock_guard<std::mutex> lock(mtx);
+    ++stats.frees;
+    FreeBlock* block = static_cast<FreeBlock*>(p);
+    block->next = freeLists[cls];
+    freeLists[cls] = block;
+}
+
+SizeClassPool::Stats SizeClassPool::getStats() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return stats;
+}
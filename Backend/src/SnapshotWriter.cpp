@@ -0,0 +1,103 @@
+#include "SnapshotWriter.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+SnapshotWriter::SnapshotWriter() : running(false) {}
+
+SnapshotWriter::~SnapshotWriter() {
+    stop();
+}
+
+void SnapshotWriter::start() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (running) return;
+    running = true;
+    worker = std::thread(&SnapshotWriter::run, this);
+}
+
+void SnapshotWriter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!running) return;
+        running = false;
+    }
+    jobCv.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+bool SnapshotWriter::scheduleCheckpoint(OperationLog& log, const std::string& path, WriteFn write) {
+    Job job{&log, path, std::move(write)};
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (inFlight.count(&log)) return false;
+        if (!log.rotate()) return false;
+        inFlight.insert(&log);
+        if (running) {
+            jobs.push_back(std::move(job));
+            jobCv.notify_one();
+            return true;
+        }
+    }
+    // No background thread: write inline.
+    execute(job);
+    return true;
+}
+
+void SnapshotWriter::waitFor(const OperationLog& log) {
+    std::unique_lock<std::mutex> lock(mtx);
+    idleCv.wait(lock, [&]() { return inFlight.count(&log) == 0; });
+}
+
+bool SnapshotWriter::writeAtomically(const std::string& path, const WriteFn& write, Durability durability) {
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) return false;
+        if (!write(out)) return false;
+        out.flush();
+        if (!out) return false;
+    }
+    const bool durable = durability != Durability::None;
+    std::error_code ec;
+    if (durable && !DurableFile::syncPath(tmpPath)) {
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec) {
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+    // The log is truncated right after this returns, so the rename must be durable too.
+    if (durable) DurableFile::syncParentDirectory(path);
+    return true;
+}
+
+void SnapshotWriter::execute(Job& job) {
+    if (writeAtomically(job.path, job.write, job.log->getDurability())) {
+        job.log->dropRotated();
+    } else {
+        // The rotated segment stays and is folded into the next rotation.
+        std::cout << "Loi: Khong the ghi snapshot " << job.path << "!\n";
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        inFlight.erase(job.log);
+    }
+    idleCv.notify_all();
+}
+
+void SnapshotWriter::run() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (true) {
+        jobCv.wait(lock, [&]() { return !jobs.empty() || !running; });
+        if (jobs.empty()) break; // stopping and drained
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+        execute(job);
+        lock.lock();
+    }
+}
@@ -0,0 +1,225 @@
+#include "StoreTransaction.h"
+#include "RoomManagement.h"
+#include "ReservationManagement.h"
+#include "InvoiceManagement.h"
+#include "JsonWriter.h"
+#include <nlohmann/json.hpp>
+#include <iostream>
+
+using json = nlohmann::json;
+
+// Journal entries are one JSON object per transaction:
+//   {"seq":7,"rooms":[{"op":"P","id":"R101","record":{...}}],"reservations":[...],"invoices":[...]}
+// seq is also written as the T marker after the transaction's records in each
+// store log, so recovery can tell which stores already hold an entry.
+static const char* const STORE_KEYS[] = {"rooms", "reservations", "invoices"};
+
+TransactionJournal::TransactionJournal(std::string path)
+    : log(std::move(path)), owedLogs{nullptr, nullptr, nullptr}, owedMarks{0, 0, 0}, owing(false),
+      lastSequence(0) {}
+
+OperationLog& TransactionJournal::getOperationLog() {
+    return log;
+}
+
+void TransactionJournal::retire() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!owing) return;
+    for (int s = 0; s < STORE_COUNT; ++s) {
+        if (owedLogs[s] && !owedLogs[s]->isFlushedThrough(owedMarks[s])) return;
+    }
+    log.truncate();
+    owing = false;
+}
+
+StoreTransaction::StoreTransaction(RoomManager& rooms, ReservationManager& reservations,
+                                   InvoiceManager& invoices, TransactionJournal& journal)
+    : rooms(rooms), reservations(reservations), invoices(invoices), journal(journal), open(true) {
+    for (int s = 0; s < STORE_COUNT; ++s) logFor(static_cast<Store>(s)).setStaging(&staged[s]);
+}
+
+StoreTransaction::~StoreTransaction() {
+    if (open) rollback();
+}
+
+OperationLog& StoreTransaction::logFor(Store store) const {
+    switch (store) {
+    case Rooms: return rooms.getOperationLog();
+    case Reservations: return reservations.getOperationLog();
+    default: return invoices.getOperationLog();
+    }
+}
+
+void StoreTransaction::restore(Store store, OperationLog::Op op, const std::string& payload) const {
+    switch (store) {
+    case Rooms: rooms.restoreRecord(op, payload); break;
+    case Reservations: reservations.restoreRecord(op, payload); break;
+    default: invoices.restoreRecord(op, payload); break;
+    }
+}
+
+void StoreTransaction::touch(Store store, const std::string& id, const std::string* json) {
+    for (const BeforeImage& img : before) {
+        if (img.store == store && img.id == id) return;
+    }
+    before.push_back({store, id, json != nullptr, json ? *json : std::string()});
+}
+
+void StoreTransaction::touchRoom(const std::string& roomId) {
+    Room* room = rooms.findRoom(roomId);
+    std::string current = room ? room->toJson() : std::string();
+    touch(Rooms, roomId, room ? &current : nullptr);
+}
+
+void StoreTransaction::touchReservation(const std::string& reservationId) {
+    Reservation* r = reservations.findReservationById(reservationId);
+    std::string current = r ? r->toJson() : std::string();
+    touch(Reservations, reservationId, r ? &current : nullptr);
+}
+
+void StoreTransaction::touchInvoice(const std::string& invoiceId) {
+    Invoice* inv = invoices.findInvoiceById(invoiceId);
+    std::string current = inv ? inv->toJson() : std::string();
+    touch(Invoices, invoiceId, inv ? &current : nullptr);
+}
+
+void StoreTransaction::endStaging() {
+    for (int s = 0; s < STORE_COUNT; ++s) logFor(static_cast<Store>(s)).setStaging(nullptr);
+}
+
+void StoreTransaction::rollback() {
+    if (!open) return;
+    open = false;
+    endStaging();
+    undo();
+}
+
+void StoreTransaction::undo() {
+    for (auto it = before.rbegin(); it != before.rend(); ++it) {
+        if (it->existed) restore(it->store, OperationLog::Op::Put, it->json);
+        else restore(it->store, OperationLog::Op::Delete, it->id);
+    }
+    before.clear();
+    for (auto& records : staged) records.clear();
+}
+
+bool StoreTransaction::commit() {
+    if (!open) return false;
+    open = false;
+    endStaging();
+
+    bool any = false;
+    for (const auto& records : staged) any = any || !records.empty();
+    if (!any) {
+        before.clear();
+        return true;
+    }
+
+    static_assert(STORE_COUNT == TransactionJournal::STORE_COUNT, "one owed mark per store");
+    // Held from numbering to hand-off so retire() never clears an entry whose
+    // records are not yet queued on the store logs.
+    std::lock_guard<std::mutex> lock(journal.mtx);
+    const std::uint64_t seq = journal.lastSequence + 1;
+
+    std::string entry;
+    JsonWriter w(entry);
+    w.beginObject();
+    w.key("seq");
+    w.raw(std::to_string(seq));
+    for (int s = 0; s < STORE_COUNT; ++s) {
+        if (staged[s].empty()) continue;
+        w.key(STORE_KEYS[s]);
+        w.beginArray();
+        for (const OperationLog::StagedRecord& rec : staged[s]) {
+            w.beginObject();
+            w.field("op", std::string(1, static_cast<char>(rec.op)));
+            w.field("id", rec.id);
+            if (rec.op == OperationLog::Op::Put) {
+                w.key("record");
+                w.raw(rec.payload);
+            }
+            w.endObject();
+        }
+        w.endArray();
+    }
+    w.endObject();
+
+    // The commit point, and the only write: one record covering every store.
+    if (!journal.log.appendPut("txn", entry)) {
+        std::cout << "Loi: Khong the ghi nhat ky giao dich!\n";
+        undo();
+        return false;
+    }
+    journal.lastSequence = seq;
+    before.clear();
+
+    // Buffered logs write these with their next group-commit or writer-queue
+    // flush; until then the journal entry is the durable copy. An unbuffered
+    // log has no later flush, so it writes them now, as it would any append.
+    for (int s = 0; s < STORE_COUNT; ++s) {
+        if (staged[s].empty()) continue;
+        OperationLog& log = logFor(static_cast<Store>(s));
+        journal.owedLogs[s] = &log;
+        journal.owedMarks[s] = log.enqueue(staged[s], seq);
+        if (!log.isBuffered()) log.flushPending();
+        staged[s].clear();
+    }
+    journal.owing = true;
+    return true;
+}
+
+int StoreTransaction::recover(RoomManager& rooms, ReservationManager& reservations, InvoiceManager& invoices,
+                              TransactionJournal& journal) {
+    StoreTransaction tx(rooms, reservations, invoices, journal);
+    tx.endStaging();
+    tx.open = false;
+
+    // The last transaction each store log (and its checkpoint) already holds.
+    // An entry is re-applied only to the stores that never received it: the
+    // others may have newer records for the same ids after its marker.
+    std::uint64_t held[STORE_COUNT];
+    for (int s = 0; s < STORE_COUNT; ++s) {
+        held[s] = tx.logFor(static_cast<Store>(s)).getLastTransaction();
+        if (held[s] > journal.lastSequence) journal.lastSequence = held[s];
+    }
+
+    int replayed = journal.log.replay([&tx, &held, &journal](OperationLog::Op, const std::string& payload) {
+        json entry;
+        std::uint64_t seq;
+        try {
+            entry = json::parse(payload);
+            // Entries written before sequence numbers existed are always applied.
+            seq = entry.value("seq", std::uint64_t(0));
+        } catch (const std::exception& e) {
+            std::cerr << "Skipping invalid transaction journal entry: " << e.what() << "\n";
+            return;
+        }
+        if (seq > journal.lastSequence) journal.lastSequence = seq;
+        for (int s = 0; s < STORE_COUNT; ++s) {
+            if (seq != 0 && seq <= held[s]) continue;
+            auto records = entry.find(STORE_KEYS[s]);
+            if (records == entry.end() || !records->is_array()) continue;
+            const Store store = static_cast<Store>(s);
+            std::vector<OperationLog::StagedRecord> applied;
+            for (const json& rec : *records) {
+                const std::string id = rec.value("id", "");
+                if (id.empty()) continue;
+                if (rec.value("op", "P") == "D") {
+                    tx.restore(store, OperationLog::Op::Delete, id);
+                    applied.push_back({OperationLog::Op::Delete, id, id});
+                } else if (rec.contains("record")) {
+                    std::string record = rec["record"].dump();
+                    tx.restore(store, OperationLog::Op::Put, record);
+                    applied.push_back({OperationLog::Op::Put, id, std::move(record)});
+                }
+            }
+            tx.logFor(store).enqueue(applied, seq);
+        }
+    });
+    if (replayed == 0) return 0;
+
+    bool logged = true;
+    for (int s = 0; s < STORE_COUNT; ++s) logged = tx.logFor(static_cast<Store>(s)).flushPending() && logged;
+    if (logged) journal.log.truncate();
+    return replayed;
+}
@@ -1,94 +1,195 @@
 #include "Structures.h"
 
+// toJson() keeps the data-file layout (records at a two-space indent); it is the
+// payload of operation-log records. Lists should use writeJson() on one writer.
+template <class T>
+static string recordToJson(const T& record) {
+    string json = "  ";
+    json.reserve(256);
+    JsonWriter w(json, JsonWriter::Style::File, 2);
+    record.writeJson(w);
+    return json;
+}
+
+// Compact JSON of a record, from its cache or built now.
+template <class T>
+static shared_ptr<const string> cachedJson(const T& record) {
+    return record.jsonCache.get([&record]() {
+        string json;
+        json.reserve(256);
+        JsonWriter w(json);
+        record.writeJson(w);
+        return json;
+    });
+}
+
+// Writes a day number as separate day, month and year fields.
+static void writeDateFields(JsonWriter& w, string_view day, string_view month, string_view year, DayNumber date) {
+    const CivilDate c = civilFromDays(date);
+    w.field(day, c.day);
+    w.field(month, c.month);
+    w.field(year, c.year);
+}
+
 // ==================== SERVICE ====================
-Service::Service(string name, double p, int q) 
-    : serviceName(name), price(p), quantity(q), next(nullptr) {}
+Service::Service(Interned name, double p, int q)
+    : serviceName(name), price(p), quantity(q) {}
 
 string Service::toJson() const {
-    return "{\n      \"serviceName\": \"" + JsonHelper::escapeString(serviceName) + 
-           "\",\n      \"price\": " + JsonHelper::formatPrice(price) + 
-           ",\n      \"quantity\": " + to_string(quantity) + "\n    }";
+    string json;
+    JsonWriter w(json, JsonWriter::Style::File, 4);
+    writeJson(w);
+    return json;
+}
+
+void Service::writeJson(JsonWriter& w) const {
+    w.beginObject();
+    w.field("serviceName", serviceName.str());
+    w.field("price", price);
+    w.field("quantity", quantity);
+    w.endObject();
 }
 
 // ==================== ROOM ====================
-Room::Room() : serviceList(nullptr), isAvailable(true) {}
+// Never destroyed: rooms in static storage may still release buffers at exit.
+static SizeClassPool& servicePool() {
+    static SizeClassPool* pool = new SizeClassPool();
+    return *pool;
+}
+
+void* ServiceBufferAlloc::allocate(size_t bytes) {
+    return servicePool().allocate(bytes);
+}
+
+void ServiceBufferAlloc::deallocate(void* p, size_t bytes) {
+    servicePool().deallocate(p, bytes);
+}
+
+SizeClassPool::Stats ServiceBufferAlloc::stats() {
+    return servicePool().getStats();
+}
+
+Room::Room() : isAvailable(true), revision(0) {}
 
 Room::Room(string id, string type, double price) 
-    : roomId(id), roomType(type), pricePerDay(price), serviceList(nullptr), isAvailable(true) {}
+    : roomId(id), roomType(type), pricePerDay(price), isAvailable(true), revision(0) {}
 
 string Room::toJson() const {
-    string json = "  {\n";
-    json += "    \"roomId\": \"" + JsonHelper::escapeString(roomId) + "\",\n";
-    json += "    \"roomType\": \"" + JsonHelper::escapeString(roomType) + "\",\n";
-    json += "    \"pricePerDay\": " + JsonHelper::formatPrice(pricePerDay) + ",\n";
-    json += "    \"isAvailable\": " + string(isAvailable ? "true" : "false") + ",\n";
-    json += "    \"services\": [";
-    
-    Service* curr = serviceList;
-    bool first = true;
-    while (curr) {
-        if (!first) json += ",";
-        json += "\n    " + curr->toJson();
-        first = false;
-        curr = curr->next;
+    return recordToJson(*this);
+}
+
+void Room::writeCachedJson(JsonWriter& w) const {
+    w.raw(*cachedJson(*this));
+}
+
+void Room::writeJson(JsonWriter& w) const {
+    w.beginObject();
+    w.field("roomId", roomId.str());
+    w.field("roomType", roomType.str());
+    w.field("pricePerDay", pricePerDay);
+    w.field("isAvailable", isAvailable);
+    w.key("services");
+    w.beginArray();
+    for (const Service& svc : services) {
+        svc.writeJson(w);
     }
-    if (!first) json += "\n    ";
-    json += "]\n  }";
-    return json;
+    w.endArray();
+    w.endObject();
 }
 
 // ==================== CUSTOMER ====================
-Customer::Customer() : next(nullptr) {}
+Customer::Customer() : revision(0) {}
 
 Customer::Customer(string id, string name, string card, string phone)
-    : customerId(id), fullName(name), idCard(card), phoneNumber(phone), next(nullptr) {}
+    : customerId(id), fullName(name), idCard(card), phoneNumber(phone), revision(0) {}
 
 string Customer::toJson() const {
-    string json = "  {\n";
-    json += "    \"customerId\": \"" + JsonHelper::escapeString(customerId) + "\",\n";
-    json += "    \"fullName\": \"" + JsonHelper::escapeString(fullName) + "\",\n";
-    json += "    \"idCard\": \"" + JsonHelper::escapeString(idCard) + "\",\n";
-    json += "    \"phoneNumber\": \"" + JsonHelper::escapeString(phoneNumber) + "\"\n";
-    json += "  }";
-    return json;
+    return recordToJson(*this);
+}
+
+void Customer::writeCachedJson(JsonWriter& w) const {
+    w.raw(*cachedJson(*this));
+}
+
+void Customer::writeJson(JsonWriter& w) const {
+    w.beginObject();
+    w.field("customerId", customerId.str());
+    w.field("fullName", fullName);
+    w.field("idCard", idCard);
+    w.field("phoneNumber", phoneNumber);
+    w.endObject();
 }
 
 // ==================== RESERVATION ====================
-Reservation::Reservation() : status("pending") {}
+static const string RESERVATION_STATUS_NAMES[] = {"pending", "checkedIn", "checkedOut", "cancel"};
+
+const string& reservationStatusName(ReservationStatus status) {
+    return RESERVATION_STATUS_NAMES[static_cast<size_t>(status)];
+}
+
+bool parseReservationStatus(string_view name, ReservationStatus& status) {
+    for (size_t i = 0; i < 4; i++) {
+        if (name == RESERVATION_STATUS_NAMES[i]) {
+            status = static_cast<ReservationStatus>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+Reservation::Reservation()
+    : checkIn(0), checkOut(0), status(ReservationStatus::Pending), revision(0) {}
 
 string Reservation::toJson() const {
-    string json = "  {\n";
-    json += "    \"reservationId\": \"" + JsonHelper::escapeString(reservationId) + "\",\n";
-    json += "    \"customerId\": \"" + JsonHelper::escapeString(customerId) + "\",\n";
-    json += "    \"roomId\": \"" + JsonHelper::escapeString(roomId) + "\",\n";
-    json += "    \"checkInDay\": " + to_string(checkInDay) + ",\n";
-    json += "    \"checkInMonth\": " + to_string(checkInMonth) + ",\n";
-    json += "    \"checkInYear\": " + to_string(checkInYear) + ",\n";
-    json += "    \"checkOutDay\": " + to_string(checkOutDay) + ",\n";
-    json += "    \"checkOutMonth\": " + to_string(checkOutMonth) + ",\n";
-    json += "    \"checkOutYear\": " + to_string(checkOutYear) + ",\n";
-    json += "    \"status\": \"" + JsonHelper::escapeString(status) + "\"\n";
-    json += "  }";
-    return json;
+    return recordToJson(*this);
+}
+
+void Reservation::writeJson(JsonWriter& w) const {
+    w.beginObject();
+    writeFields(w);
+    w.endObject();
+}
+
+void Reservation::writeCachedJson(JsonWriter& w) const {
+    w.raw(*cachedJson(*this));
+}
+
+void Reservation::writeCachedFields(JsonWriter& w) const {
+    shared_ptr<const string> json = cachedJson(*this);
+    // Strip the braces: the caller owns the enclosing object.
+    w.rawFields(string_view(*json).substr(1, json->size() - 2));
+}
+
+void Reservation::writeFields(JsonWriter& w) const {
+    w.field("reservationId", reservationId);
+    w.field("customerId", customerId.str());
+    w.field("roomId", roomId.str());
+    writeDateFields(w, "checkInDay", "checkInMonth", "checkInYear", checkIn);
+    writeDateFields(w, "checkOutDay", "checkOutMonth", "checkOutYear", checkOut);
+    w.field("status", reservationStatusName(status));
 }
 
 // ==================== INVOICE ====================
-Invoice::Invoice() : roomCharge(0), serviceCharge(0), totalAmount(0) {}
+Invoice::Invoice()
+    : checkIn(0), checkOut(0), roomCharge(0), serviceCharge(0), totalAmount(0), revision(0) {}
 
 string Invoice::toJson() const {
-    string json = "  {\n";
-    json += "    \"invoiceId\": \"" + JsonHelper::escapeString(invoiceId) + "\",\n";
-    json += "    \"customerId\": \"" + JsonHelper::escapeString(customerId) + "\",\n";
-    json += "    \"roomId\": \"" + JsonHelper::escapeString(roomId) + "\",\n";
-    json += "    \"checkInDay\": " + to_string(checkInDay) + ",\n";
-    json += "    \"checkInMonth\": " + to_string(checkInMonth) + ",\n";
-    json += "    \"checkInYear\": " + to_string(checkInYear) + ",\n";
-    json += "    \"checkOutDay\": " + to_string(checkOutDay) + ",\n";
-    json += "    \"checkOutMonth\": " + to_string(checkOutMonth) + ",\n";
-    json += "    \"checkOutYear\": " + to_string(checkOutYear) + ",\n";
-    json += "    \"roomCharge\": " + JsonHelper::formatPrice(roomCharge) + ",\n";
-    json += "    \"serviceCharge\": " + JsonHelper::formatPrice(serviceCharge) + ",\n";
-    json += "    \"totalAmount\": " + JsonHelper::formatPrice(totalAmount) + "\n";
-    json += "  }";
-    return json;
-}
\ No newline at end of file
+    return recordToJson(*this);
+}
+
+void Invoice::writeCachedJson(JsonWriter& w) const {
+    w.raw(*cachedJson(*this));
+}
+
+void Invoice::writeJson(JsonWriter& w) const {
+    w.beginObject();
+    w.field("invoiceId", invoiceId);
+    w.field("customerId", customerId.str());
+    w.field("roomId", roomId.str());
+    writeDateFields(w, "checkInDay", "checkInMonth", "checkInYear", checkIn);
+    writeDateFields(w, "checkOutDay", "checkOutMonth", "checkOutYear", checkOut);
+    w.field("roomCharge", roomCharge);
+    w.field("serviceCharge", serviceCharge);
+    w.field("totalAmount", totalAmount);
+    w.endObject();
+}
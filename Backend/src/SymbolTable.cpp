@@ -0,0 +1,74 @@
+#include "SymbolTable.h"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+SymbolTable& SymbolTable::global() {
+    // Leaked so records destroyed during static teardown can still be read.
+    static SymbolTable* table = new SymbolTable();
+    return *table;
+}
+
+SymbolTable::SymbolTable(bool foldCase) : count(0), foldCase(foldCase) {
+    for (auto& block : blocks) block.store(nullptr, std::memory_order_relaxed);
+    std::lock_guard<std::shared_mutex> lock(mtx);
+    internLocked(std::string_view());
+}
+
+SymbolTable::~SymbolTable() {
+    for (auto& block : blocks) delete[] block.load(std::memory_order_relaxed);
+}
+
+SymbolTable::Symbol SymbolTable::intern(std::string_view name) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mtx);
+        auto it = index.find(name);
+        if (it != index.end()) return it->second;
+    }
+    // internLocked() looks again: another thread may have added it meanwhile.
+    std::lock_guard<std::shared_mutex> lock(mtx);
+    return internLocked(name);
+}
+
+bool SymbolTable::find(std::string_view name, Symbol& sym) const {
+    std::shared_lock<std::shared_mutex> lock(mtx);
+    auto it = index.find(name);
+    if (it == index.end()) return false;
+    sym = it->second;
+    return true;
+}
+
+bool SymbolTable::fitsBudget(std::string_view name, std::size_t budget) const {
+    Symbol existing;
+    if (find(name, existing)) return true;
+    return size() + 2 <= budget;
+}
+
+SymbolTable::Symbol SymbolTable::internLocked(std::string_view name) {
+    auto it = index.find(name);
+    if (it != index.end()) return it->second;
+
+    const std::size_t n = count.load(std::memory_order_relaxed);
+    if (n >= MAX_SYMBOLS) throw std::length_error("SymbolTable is full");
+    Entry* block = blocks[n / BLOCK_SIZE].load(std::memory_order_relaxed);
+    if (!block) {
+        block = new Entry[BLOCK_SIZE];
+        blocks[n / BLOCK_SIZE].store(block, std::memory_order_release);
+    }
+
+    const Symbol sym = static_cast<Symbol>(n);
+    Entry& e = block[n % BLOCK_SIZE];
+    e.name.assign(name.data(), name.size());
+    e.folded = sym;
+    index.emplace(std::string_view(e.name), sym);
+    count.store(n + 1, std::memory_order_release);
+    if (!foldCase) return sym;
+
+    std::string lower = e.name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    if (lower != e.name) e.folded = internLocked(lower);
+    return sym;
+}
@@ -0,0 +1,108 @@
+#include "WriteQueue.h"
+
+WriteQueue::WriteQueue(const StoreLocks& locks)
+    : locks(locks), pending(nullptr), running(false), batches(0), commands(0) {}
+
+WriteQueue::~WriteQueue() {
+    stop();
+}
+
+void WriteQueue::setFlush(std::function<void()> fn) {
+    flush = std::move(fn);
+}
+
+void WriteQueue::start() {
+    if (running.exchange(true)) return;
+    writer = std::thread(&WriteQueue::runLoop, this);
+}
+
+void WriteQueue::stop() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMtx);
+        if (!running.exchange(false)) return;
+    }
+    wakeCv.notify_all();
+    if (writer.joinable()) writer.join();
+    // Anything pushed while stopping still gets its answer.
+    if (Command* batch = takeBatch()) runBatch(batch);
+}
+
+bool WriteQueue::isRunning() const {
+    return running.load(std::memory_order_acquire);
+}
+
+std::uint64_t WriteQueue::getBatchCount() const {
+    return batches.load();
+}
+
+std::uint64_t WriteQueue::getCommandCount() const {
+    return commands.load();
+}
+
+void WriteQueue::push(Command* cmd) {
+    Command* head = pending.load(std::memory_order_relaxed);
+    do {
+        cmd->next = head;
+    } while (!pending.compare_exchange_weak(head, cmd, std::memory_order_release, std::memory_order_relaxed));
+
+    // Only the push onto an empty stack can find the writer asleep.
+    if (head == nullptr) {
+        std::lock_guard<std::mutex> lock(wakeMtx);
+        wakeCv.notify_one();
+    }
+}
+
+WriteQueue::Command* WriteQueue::takeBatch() {
+    Command* stack = pending.exchange(nullptr, std::memory_order_acquire);
+    // Reverse into arrival order.
+    Command* batch = nullptr;
+    while (stack) {
+        Command* next = stack->next;
+        stack->next = batch;
+        batch = stack;
+        stack = next;
+    }
+    return batch;
+}
+
+void WriteQueue::runLoop() {
+    while (true) {
+        Command* batch = takeBatch();
+        if (!batch) {
+            std::unique_lock<std::mutex> lock(wakeMtx);
+            wakeCv.wait(lock, [this]() {
+                return pending.load(std::memory_order_acquire) != nullptr || !running.load();
+            });
+            if (!running.load()) break;
+            continue;
+        }
+        runBatch(batch);
+    }
+}
+
+void WriteQueue::runBatch(Command* batch) {
+    std::uint64_t n = 0;
+    {
+        auto guard = locks.write(StoreLocks::All);
+        for (Command* cmd = batch; cmd; cmd = cmd->next) {
+            try {
+                cmd->run();
+            } catch (...) {
+                cmd->error = std::current_exception();
+            }
+            ++n;
+        }
+    }
+    // One flush for the whole batch; nobody is answered before it is durable.
+    if (flush) flush();
+    batches.fetch_add(1);
+    commands.fetch_add(n);
+
+    while (batch) {
+        Command* next = batch->next;
+        if (batch->error) batch->done.set_exception(batch->error);
+        else batch->done.set_value();
+        delete batch;
+        batch = next;
+    }
+}
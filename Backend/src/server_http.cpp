@@ -6,6 +6,13 @@
 #include "JsonHelper.h"
 #include "AdvanceFeatures.h"
 #include "ServiceManagement.h"
+#include "GroupCommitFlusher.h"
+#include "SnapshotWriter.h"
+#include "ThreadPool.h"
+#include "StoreLocks.h"
+#include "ViewSnapshot.h"
+#include "WriteQueue.h"
+#include "StoreTransaction.h"
 #include <nlohmann/json.hpp>
 #include <string>
 #include <vector>
@@ -13,80 +20,109 @@
 #include <unordered_map>
 #include <chrono>
 #include <filesystem>
+#include <memory>
+#include <thread>
+#include <random>
+#include <cstdio>
 
 using json = nlohmann::json;
 
-static json roomToJson(const Room &room) {
-    json j;
-    j["roomId"] = std::string(room.roomId);
-    j["roomType"] = std::string(room.roomType);
-    j["pricePerDay"] = room.pricePerDay;
-    j["isAvailable"] = room.isAvailable;
-    json services = json::array();
-    for (Service* svc = room.serviceList; svc != nullptr; svc = svc->next) {
-        services.push_back({
-            {"serviceName", std::string(svc->serviceName)},
-            {"price", svc->price},
-            {"quantity", svc->quantity}
-        });
-    }
-    j["services"] = services;
-    return j;
+// Response bodies for records and lists go through JsonWriter: one buffer per
+// response, filled from each record's cached JSON fragment (rebuilt only after
+// the record changes) instead of an nlohmann DOM per record.
+template <class T>
+static std::string recordBody(const T& record) {
+    std::string body;
+    JsonWriter w(body);
+    record.writeCachedJson(w);
+    return body;
+}
+
+// Sends a published view body without copying it; the provider keeps the body
+// alive until the response has been written.
+static void setViewContent(httplib::Response &res, std::shared_ptr<const std::string> body) {
+    const size_t size = body->size();
+    res.set_content_provider(size, "application/json",
+                             [body](size_t offset, size_t length, httplib::DataSink &sink) {
+                                 return sink.write(body->data() + offset, length);
+                             });
+}
+
+// ETag of a record: "<boot>-<revision>". Revisions restart with the process, so
+// the per-start boot id keeps a tag from before a restart from ever matching.
+static std::string recordETag(uint64_t revision) {
+    static const std::string boot = []() {
+        std::random_device rd;
+        char buf[17];
+        snprintf(buf, sizeof(buf), "%08x%08x", rd(), rd());
+        return std::string(buf);
+    }();
+    return "\"" + boot + "-" + std::to_string(revision) + "\"";
 }
 
-static json customerToJson(const Customer &c) {
-    json j;
-    j["customerId"] = std::string(c.customerId);
-    j["fullName"] = std::string(c.fullName);
-    j["idCard"] = std::string(c.idCard);
-    j["phoneNumber"] = std::string(c.phoneNumber);
-    return j;
+// Conditional writes: passes when If-Match is absent, "*", or lists etag.
+static bool ifMatchAllows(const httplib::Request &req, const std::string &etag) {
+    if (!req.has_header("If-Match")) return true;
+    const std::string header = req.get_header_value("If-Match");
+    size_t pos = 0;
+    while (pos <= header.size()) {
+        size_t comma = header.find(',', pos);
+        if (comma == std::string::npos) comma = header.size();
+        size_t b = header.find_first_not_of(" \t", pos);
+        size_t e = header.find_last_not_of(" \t", comma - 1);
+        if (b != std::string::npos && b < comma && e != std::string::npos && e >= b) {
+            std::string tag = header.substr(b, e - b + 1);
+            if (tag == "*" || tag == etag) return true;
+        }
+        pos = comma + 1;
+    }
+    return false;
 }
 
-static json reservationToJson(const Reservation &r) {
-    json j;
-    j["reservationId"] = std::string(r.reservationId);
-    j["customerId"] = std::string(r.customerId);
-    j["roomId"] = std::string(r.roomId);
-    j["checkInDay"] = r.checkInDay;
-    j["checkInMonth"] = r.checkInMonth;
-    j["checkInYear"] = r.checkInYear;
-    j["checkOutDay"] = r.checkOutDay;
-    j["checkOutMonth"] = r.checkOutMonth;
-    j["checkOutYear"] = r.checkOutYear;
-    j["status"] = std::string(r.status);
-    return j;
+// 412 with the record's current ETag, so the client can re-read and retry.
+static void preconditionFailed(httplib::Response &res, const std::string &etag) {
+    res.status = 412;
+    res.set_header("ETag", etag);
+    res.set_content("{\"error\":\"Record was modified by another request\"}", "application/json");
 }
 
-static json invoiceToJson(const Invoice &inv) {
-    json j;
-    j["invoiceId"] = std::string(inv.invoiceId);
-    j["customerId"] = std::string(inv.customerId);
-    j["roomId"] = std::string(inv.roomId);
-    j["checkInDay"] = inv.checkInDay;
-    j["checkInMonth"] = inv.checkInMonth;
-    j["checkInYear"] = inv.checkInYear;
-    j["checkOutDay"] = inv.checkOutDay;
-    j["checkOutMonth"] = inv.checkOutMonth;
-    j["checkOutYear"] = inv.checkOutYear;
-    j["roomCharge"] = inv.roomCharge;
-    j["serviceCharge"] = inv.serviceCharge;
-    j["totalAmount"] = inv.totalAmount;
-    return j;
+// Runs a write on one reservation under its room's shard. The room is looked
+// up first under a read lock; if the reservation was replaced by one for
+// another room before the shard was taken, the lookup is repeated.
+template <class F>
+static void executeForReservation(WriteQueue &writes, const StoreLocks &locks, ReservationManager &resMgr,
+                                  const std::string &reservationId, unsigned mask, F body) {
+    for (;;) {
+        std::string roomId;
+        if (locks.isSharded() && !writes.isRunning()) {
+            auto guard = locks.read(StoreLocks::Reservations);
+            if (Reservation* r = resMgr.findReservationById(reservationId)) roomId = r->roomId.str();
+        }
+        bool moved = false;
+        writes.executeForRoom(mask, roomId, [&]() {
+            Reservation* r = resMgr.findReservationById(reservationId);
+            if (locks.isSharded() && !writes.isRunning() && (r ? r->roomId.str() : std::string()) != roomId) {
+                moved = true;
+                return;
+            }
+            body();
+        });
+        if (!moved) return;
+    }
 }
 
 static json serviceListToJson(const Room &room) {
     json arr = json::array();
     int idx = 0;
     double total = 0;
-    for (Service* svc = room.serviceList; svc != nullptr; svc = svc->next) {
-        double line = svc->price * svc->quantity;
+    for (const Service& svc : room.services) {
+        double line = svc.price * svc.quantity;
         total += line;
         arr.push_back({
             {"index", idx},
-            {"serviceName", std::string(svc->serviceName)},
-            {"price", svc->price},
-            {"quantity", svc->quantity},
+            {"serviceName", svc.serviceName.str()},
+            {"price", svc.price},
+            {"quantity", svc.quantity},
             {"total", line}
         });
         ++idx;
@@ -99,38 +135,63 @@ static json serviceListToJson(const Room &room) {
 }
 
 static void reconcile_room_availability(RoomManager& roomMgr, ReservationManager& resMgr) {
-    Room* rooms = roomMgr.getRooms();
-    int roomCount = roomMgr.getRoomCount();
-    Reservation* reservations = resMgr.getReservations();
-    int resCount = resMgr.getReservationCount();
-
-    // Default all rooms to available, then mark unavailable if any pending/checkedIn reservation exists.
-    for (int i = 0; i < roomCount; ++i) {
-        rooms[i].isAvailable = true;
-    }
-    for (int i = 0; i < resCount; ++i) {
-        const Reservation& r = reservations[i];
-        if (r.status == "pending" || r.status == "checkedIn") {
-            if (Room* room = roomMgr.findRoom(r.roomId)) {
-                room->isAvailable = false;
-            }
-        }
-    }
-
+    // A room is unavailable while it has a pending/checkedIn reservation; the
+    // reservation manager's per-room index answers that without a scan.
     // Business rule: only occupied (isAvailable=false) rooms can have services.
     // If a room is available, wipe any leftover services from legacy/invalid data.
-    for (int i = 0; i < roomCount; ++i) {
-        if (rooms[i].isAvailable && rooms[i].serviceList != nullptr) {
-            // Persist cleanup so stale services don't leak into the next occupancy.
-            ServiceManagement::clearServices(roomMgr, std::string(rooms[i].roomId), true);
+    roomMgr.forEachRoom([&roomMgr, &resMgr](Room& room) {
+        room.isAvailable = !resMgr.hasActiveReservation(room.roomId);
+        if (room.isAvailable && !room.services.empty()) {
+            // Persisted by the checkpoint below so stale services don't leak into the next occupancy.
+            ServiceManagement::clearServices(roomMgr, room.roomId.str(), false);
         }
-    }
+    });
 
-    // Persist once.
+    // Persist once (full checkpoint; also clears the replayed operation log).
     roomMgr.saveToFile();
 }
 
-int main() {
+int main(int argc, char** argv) {
+    // Group-commit window for the operation logs; 0 writes every mutation synchronously.
+    int flushWindowMs = 10;
+    // Checkpoints are written by a snapshot thread unless "inline" is requested.
+    bool backgroundSnapshots = true;
+    StorageFormat storageFormat = StorageFormat::Json;
+    Durability durability = Durability::None;
+    // Mutations run on a single writer thread instead of under per-request locks.
+    bool queuedWrites = false;
+    // Lock stripes over the room and reservation stores; 0 = one lock per store.
+    unsigned roomShards = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--flush-window-ms" && i + 1 < argc) {
+            flushWindowMs = std::max(0, std::stoi(argv[++i]));
+        } else if (a == "--snapshot-mode" && i + 1 < argc) {
+            backgroundSnapshots = std::string(argv[++i]) != "inline";
+        } else if (a == "--storage" && i + 1 < argc) {
+            storageFormat = std::string(argv[++i]) == "binary" ? StorageFormat::Binary : StorageFormat::Json;
+        } else if (a == "--durability" && i + 1 < argc) {
+            std::string level = argv[++i];
+            if (level == "batch") durability = Durability::FsyncPerBatch;
+            else if (level == "op") durability = Durability::FsyncPerOp;
+            else if (level == "dsync") durability = Durability::DSync;
+            else durability = Durability::None;
+        } else if (a == "--write-mode" && i + 1 < argc) {
+            queuedWrites = std::string(argv[++i]) == "queue";
+        } else if (a == "--room-shards" && i + 1 < argc) {
+            roomShards = static_cast<unsigned>(std::max(0, std::stoi(argv[++i])));
+        } else if (a == "--help" || a == "-h") {
+            printf("server_http options:\n"
+                   "  --flush-window-ms <int>   group-commit window in ms, 0 = sync writes (default 10)\n"
+                   "  --snapshot-mode <mode>    background | inline checkpoints (default background)\n"
+                   "  --storage <format>        json | binary checkpoint files (default json)\n"
+                   "  --durability <level>      none | batch | op | dsync fsync policy (default none)\n"
+                   "  --write-mode <mode>       direct | queue (single writer thread) (default direct)\n"
+                   "  --room-shards <int>       lock shards for per-room writes, 0 = off (default 0)\n");
+            return 0;
+        }
+    }
+
     // Ensure we can find JSON + Frontend folder regardless of working directory.
     namespace fs = std::filesystem;
     auto hasAnyDataFile = [](const fs::path& p) {
@@ -155,10 +216,39 @@ int main() {
     ReservationManager resMgr;
     InvoiceManager invMgr;
 
-    roomMgr.loadFromFile();
-    custMgr.loadFromFile();
-    resMgr.loadFromFile();
-    invMgr.loadFromFile();
+    roomMgr.setStorageFormat(storageFormat);
+    custMgr.setStorageFormat(storageFormat);
+    resMgr.setStorageFormat(storageFormat);
+    invMgr.setStorageFormat(storageFormat);
+    roomMgr.getOperationLog().setDurability(durability);
+    custMgr.getOperationLog().setDurability(durability);
+    resMgr.getOperationLog().setDurability(durability);
+    invMgr.getOperationLog().setDurability(durability);
+
+    // The four stores are independent until reconcile: load them concurrently, and
+    // let the big JSON arrays split their parsing across the pool.
+    auto loadStart = std::chrono::steady_clock::now();
+    {
+        ThreadPool loadPool;
+        std::thread roomLoader([&roomMgr]() { roomMgr.loadFromFile(); });
+        std::thread custLoader([&custMgr, &loadPool]() { custMgr.loadFromFile(&loadPool); });
+        std::thread resLoader([&resMgr, &loadPool]() { resMgr.loadFromFile(&loadPool); });
+        invMgr.loadFromFile(&loadPool);
+        roomLoader.join();
+        custLoader.join();
+        resLoader.join();
+    }
+    std::chrono::duration<double, std::milli> loadMs = std::chrono::steady_clock::now() - loadStart;
+    printf("[Server] Loaded %d rooms, %d customers, %d reservations, %d invoices in %.1f ms\n",
+           roomMgr.getRoomCount(), custMgr.getCustomerCount(), resMgr.getReservationCount(),
+           invMgr.getInvoiceCount(), loadMs.count());
+
+    // Finish any multi-store transaction cut short by a crash.
+    TransactionJournal txJournal("transactions.log");
+    txJournal.getOperationLog().setDurability(durability);
+    if (int replayed = StoreTransaction::recover(roomMgr, resMgr, invMgr, txJournal)) {
+        printf("[Server] Recovered %d interrupted transaction(s)\n", replayed);
+    }
 
     // Keep rooms.json and reservations.json consistent on startup.
     reconcile_room_availability(roomMgr, resMgr);
@@ -167,8 +257,70 @@ int main() {
     // No-op if there are no duplicates.
     ServiceManagement::mergeDuplicateServices(roomMgr, true);
 
+    SnapshotWriter snapshotWriter;
+    if (backgroundSnapshots) {
+        snapshotWriter.start();
+        roomMgr.setSnapshotWriter(&snapshotWriter);
+        custMgr.setSnapshotWriter(&snapshotWriter);
+        resMgr.setSnapshotWriter(&snapshotWriter);
+        invMgr.setSnapshotWriter(&snapshotWriter);
+    }
+
+    // With fsync enabled, the four logs are synced in parallel on their own
+    // threads (no io_uring dependency; this is the portable fallback).
+    std::unique_ptr<ThreadPool> ioPool;
+    GroupCommitFlusher flusher(flushWindowMs);
+    if (durability != Durability::None) {
+        ioPool.reset(new ThreadPool(4));
+        flusher.setIoPool(ioPool.get());
+    }
+    // In queue mode the writer thread flushes once per batch, so the logs are
+    // buffered but the flusher's own thread is not started.
+    if (flushWindowMs > 0 || queuedWrites) {
+        flusher.attach(roomMgr.getOperationLog());
+        flusher.attach(custMgr.getOperationLog());
+        flusher.attach(resMgr.getOperationLog());
+        flusher.attach(invMgr.getOperationLog());
+        if (!queuedWrites) flusher.start();
+    }
+
+    // Handlers lock the stores they touch; parallel GETs only share locks.
+    StoreLocks locks(roomMgr.getMutex(), custMgr.getMutex(), resMgr.getMutex(), invMgr.getMutex());
+    locks.setRoomShards(roomShards);
+    if (locks.isSharded()) {
+        roomMgr.setDeferredCheckpoints(true);
+        resMgr.setDeferredCheckpoints(true);
+    }
+
+    // Mutations run inline under their store locks, or on one writer thread in queue mode.
+    WriteQueue writes(locks);
+    if (queuedWrites) {
+        writes.setFlush([&flusher]() { flusher.waitDurable(); });
+        writes.start();
+    }
+
+    // The heavy list endpoints serve published bodies without taking store locks.
+    ViewSnapshot reservationView;
+    ViewSnapshot serviceRoomView;
+    ViewSnapshot invoiceView;
+
     httplib::Server app;
 
+    // Acknowledge mutating requests only once their log records are on disk.
+    // Queued writes are already durable when their handler returns.
+    app.set_post_routing_handler([&flusher, &writes, &locks, &roomMgr, &resMgr, &txJournal](const httplib::Request &req, httplib::Response &) {
+        if (req.method == "GET" || req.method == "HEAD") return;
+        if (!writes.isRunning()) flusher.waitDurable();
+        // Clear the transaction journal once the store logs have caught up with it.
+        txJournal.retire();
+        // Per-room writes only share the store locks; checkpoints wait for an exclusive one.
+        if (locks.isSharded() && (roomMgr.checkpointDue() || resMgr.checkpointDue())) {
+            auto guard = locks.write(StoreLocks::Rooms | StoreLocks::Reservations);
+            roomMgr.runDueCheckpoint();
+            resMgr.runDueCheckpoint();
+        }
+    });
+
     // Serve static frontend files (Frontend folder is one level up from Backend)
     if (!app.set_mount_point("/", "../Frontend")) {
         try {
@@ -192,17 +344,19 @@ int main() {
     });
 
     // Rooms
-    app.Get("/api/rooms", [&roomMgr](const httplib::Request &, httplib::Response &res) {
-        auto rooms = roomMgr.getRooms();
-        int n = roomMgr.getRoomCount();
-        json arr = json::array();
-        for (int i = 0; i < n; ++i) {
-            arr.push_back(roomToJson(rooms[i]));
-        }
-        res.set_content(arr.dump(), "application/json");
+    app.Get("/api/rooms", [&roomMgr, &locks](const httplib::Request &, httplib::Response &res) {
+        auto guard = locks.read(StoreLocks::Rooms);
+        std::string body;
+        body.reserve(static_cast<size_t>(roomMgr.getRoomCount()) * 128);
+        JsonWriter w(body);
+        w.beginArray();
+        roomMgr.forEachRoom([&w](const Room& room) { room.writeCachedJson(w); });
+        w.endArray();
+        res.set_content(std::move(body), "application/json");
     });
 
-    app.Get(R"(/api/rooms/(.+))", [&roomMgr](const httplib::Request &req, httplib::Response &res) {
+    app.Get(R"(/api/rooms/(.+))", [&roomMgr, &locks](const httplib::Request &req, httplib::Response &res) {
+        auto guard = locks.read(StoreLocks::Rooms);
         std::string roomId = req.matches[1];
         Room* room = roomMgr.findRoom(roomId);
         if (!room) {
@@ -210,51 +364,90 @@ int main() {
             res.set_content("{\"error\":\"Room not found\"}", "application/json");
             return;
         }
-        res.set_content(roomToJson(*room).dump(), "application/json");
+        res.set_header("ETag", recordETag(room->revision));
+        res.set_content(recordBody(*room), "application/json");
     });
 
-    app.Post("/api/rooms", [&roomMgr](const httplib::Request &req, httplib::Response &res) {
-        try {
-            auto d = json::parse(req.body);
-            roomMgr.addRoom(d.at("roomId"), d.at("roomType"), d.at("pricePerDay"));
-            res.status = 201;
-            res.set_content("{\"message\":\"Room added\"}", "application/json");
-        } catch (const std::exception &e) {
-            res.status = 400;
-            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
-        }
+    app.Post("/api/rooms", [&roomMgr, &writes](const httplib::Request &req, httplib::Response &res) {
+        writes.execute(0, StoreLocks::Rooms, [&]() {
+            try {
+                auto d = json::parse(req.body);
+                const std::string roomType = d.at("roomType");
+                if (!RoomManager::isValidRoomType(roomType)) {
+                    res.status = 400;
+                    res.set_content("{\"error\":\"Invalid room type\"}", "application/json");
+                    return;
+                }
+                roomMgr.addRoom(d.at("roomId"), roomType, d.at("pricePerDay"));
+                res.status = 201;
+                res.set_content("{\"message\":\"Room added\"}", "application/json");
+            } catch (const std::exception &e) {
+                res.status = 400;
+                res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+            }
+        });
     });
 
-    app.Delete(R"(/api/rooms/(.+))", [&roomMgr](const httplib::Request &req, httplib::Response &res) {
-        try {
-            roomMgr.deleteRoom(req.matches[1]);
-            res.set_content("{\"message\":\"Room deleted\"}", "application/json");
-        } catch (const std::exception &e) {
-            res.status = 400;
-            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
-        }
+    app.Delete(R"(/api/rooms/(.+))", [&roomMgr, &writes](const httplib::Request &req, httplib::Response &res) {
+        writes.execute(0, StoreLocks::Rooms, [&]() {
+            try {
+                std::string roomId = req.matches[1];
+                if (Room* room = roomMgr.findRoom(roomId)) {
+                    const std::string etag = recordETag(room->revision);
+                    if (!ifMatchAllows(req, etag)) {
+                        preconditionFailed(res, etag);
+                        return;
+                    }
+                }
+                roomMgr.deleteRoom(roomId);
+                res.set_content("{\"message\":\"Room deleted\"}", "application/json");
+            } catch (const std::exception &e) {
+                res.status = 400;
+                res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+            }
+        });
     });
 
-    app.Get(R"(/api/rooms/sort/(asc|desc))", [&roomMgr](const httplib::Request &req, httplib::Response &res) {
-        bool asc = req.matches[1] == "asc";
-        roomMgr.sortRoomsByPrice(asc);
-        auto rooms = roomMgr.getRooms();
-        int n = roomMgr.getRoomCount();
-        json arr = json::array();
-        for (int i = 0; i < n; ++i) arr.push_back(roomToJson(rooms[i]));
-        res.set_content(arr.dump(), "application/json");
+    app.Get(R"(/api/rooms/sort/(asc|desc))", [&roomMgr, &writes](const httplib::Request &req, httplib::Response &res) {
+        writes.execute(0, StoreLocks::Rooms, [&]() {
+            bool asc = req.matches[1] == "asc";
+            roomMgr.sortRoomsByPrice(asc);
+            std::string body;
+            JsonWriter w(body);
+            w.beginArray();
+            roomMgr.forEachRoom([&w](const Room& room) { room.writeCachedJson(w); });
+            w.endArray();
+            res.set_content(std::move(body), "application/json");
+        });
     });
 
     // Customers
-    app.Get("/api/customers", [&custMgr](const httplib::Request &, httplib::Response &res) {
-        json arr = json::array();
-        for (Customer* c = custMgr.getHead(); c != nullptr; c = c->next) {
-            arr.push_back(customerToJson(*c));
-        }
-        res.set_content(arr.dump(), "application/json");
+    app.Get("/api/customers", [&custMgr, &locks](const httplib::Request &, httplib::Response &res) {
+        auto guard = locks.read(StoreLocks::Customers);
+        std::string body;
+        body.reserve(static_cast<size_t>(custMgr.getCustomerCount()) * 112);
+        JsonWriter w(body);
+        w.beginArray();
+        custMgr.forEachCustomer([&w](const Customer& c) { c.writeCachedJson(w); });
+        w.endArray();
+        res.set_content(std::move(body), "application/json");
     });
 
-    app.Get(R"(/api/customers/(.+))", [&custMgr](const httplib::Request &req, httplib::Response &res) {
+    // Registered before /api/customers/(.+), which would otherwise match it.
+    app.Get(R"(/api/customers/sort/(asc|desc))", [&custMgr, &locks](const httplib::Request &req, httplib::Response &res) {
+        auto guard = locks.read(StoreLocks::Customers);
+        bool asc = req.matches[1] == "asc";
+        std::string body;
+        body.reserve(static_cast<size_t>(custMgr.getCustomerCount()) * 112);
+        JsonWriter w(body);
+        w.beginArray();
+        custMgr.forEachCustomerByName(asc, [&w](Customer& c) { c.writeCachedJson(w); });
+        w.endArray();
+        res.set_content(std::move(body), "application/json");
+    });
+
+    app.Get(R"(/api/customers/(.+))", [&custMgr, &locks](const httplib::Request &req, httplib::Response &res) {
+        auto guard = locks.read(StoreLocks::Customers);
         std::string customerId = req.matches[1];
         Customer* customer = custMgr.findCustomer(customerId);
         if (!customer) {
@@ -262,88 +455,123 @@ int main() {
             res.set_content("{\"error\":\"Customer not found\"}", "application/json");
             return;
         }
-        res.set_content(customerToJson(*customer).dump(), "application/json");
-    });
-
-    app.Post("/api/customers", [&custMgr](const httplib::Request &req, httplib::Response &res) {
-        try {
-            auto d = json::parse(req.body);
-            custMgr.addCustomer(d.at("customerId"), d.at("fullName"), d.at("idCard"), d.at("phoneNumber"));
-            res.status = 201;
-            res.set_content("{\"message\":\"Customer added\"}", "application/json");
-        } catch (const std::exception &e) {
-            res.status = 400;
-            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
-        }
+        res.set_header("ETag", recordETag(customer->revision));
+        res.set_content(recordBody(*customer), "application/json");
     });
 
-    app.Delete(R"(/api/customers/(.+))", [&custMgr](const httplib::Request &req, httplib::Response &res) {
-        try {
-            custMgr.deleteCustomer(req.matches[1]);
-            res.set_content("{\"message\":\"Customer deleted\"}", "application/json");
-        } catch (const std::exception &e) {
-            res.status = 400;
-            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
-        }
+    app.Post("/api/customers", [&custMgr, &writes](const httplib::Request &req, httplib::Response &res) {
+        writes.execute(0, StoreLocks::Customers, [&]() {
+            try {
+                auto d = json::parse(req.body);
+                custMgr.addCustomer(d.at("customerId"), d.at("fullName"), d.at("idCard"), d.at("phoneNumber"));
+                res.status = 201;
+                res.set_content("{\"message\":\"Customer added\"}", "application/json");
+            } catch (const std::exception &e) {
+                res.status = 400;
+                res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+            }
+        });
     });
 
-    app.Get(R"(/api/customers/sort/(asc|desc))", [&custMgr](const httplib::Request &req, httplib::Response &res) {
-        bool asc = req.matches[1] == "asc";
-        std::vector<Customer*> nodes;
-        for (Customer* c = custMgr.getHead(); c != nullptr; c = c->next) nodes.push_back(c);
-        std::sort(nodes.begin(), nodes.end(), [asc](Customer* a, Customer* b) {
-            if (asc) return a->fullName < b->fullName;
-            return a->fullName > b->fullName;
+    app.Delete(R"(/api/customers/(.+))", [&custMgr, &writes](const httplib::Request &req, httplib::Response &res) {
+        writes.execute(0, StoreLocks::Customers, [&]() {
+            try {
+                std::string customerId = req.matches[1];
+                if (Customer* customer = custMgr.findCustomer(customerId)) {
+                    const std::string etag = recordETag(customer->revision);
+                    if (!ifMatchAllows(req, etag)) {
+                        preconditionFailed(res, etag);
+                        return;
+                    }
+                }
+                custMgr.deleteCustomer(customerId);
+                res.set_content("{\"message\":\"Customer deleted\"}", "application/json");
+            } catch (const std::exception &e) {
+                res.status = 400;
+                res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+            }
         });
-        json arr = json::array();
-        for (Customer* c : nodes) arr.push_back(customerToJson(*c));
-        res.set_content(arr.dump(), "application/json");
     });
 
     // Reservations
-    app.Get("/api/reservations", [&resMgr, &custMgr](const httplib::Request &, httplib::Response &res) {
-        auto rs = resMgr.getReservations();
-        int n = resMgr.getReservationCount();
-        json arr = json::array();
+    app.Get("/api/reservations", [&resMgr, &custMgr, &locks, &reservationView](const httplib::Request &, httplib::Response &res) {
+        auto body = reservationView.get(
+            [&resMgr, &custMgr]() { return custMgr.getVersion() + resMgr.getVersion(); },
+            [&locks]() { return locks.read(StoreLocks::Customers | StoreLocks::Reservations); },
+            [&resMgr, &custMgr]() {
+                std::string body;
+                body.reserve(static_cast<size_t>(resMgr.getReservationCount()) * 256);
+                JsonWriter w(body);
+                w.beginArray();
+                resMgr.forEachReservation([&w, &custMgr](const Reservation &r) {
+                    w.beginObject();
+                    r.writeCachedFields(w);
+                    if (Customer* c = custMgr.findCustomer(r.customerId)) {
+                        w.field("fullName", c->fullName);
+                    }
+                    w.endObject();
+                });
+                w.endArray();
+                return body;
+            });
+        setViewContent(res, std::move(body));
+    });
+
+    app.Post("/api/reservations", [&resMgr, &custMgr, &roomMgr, &invMgr, &txJournal, &writes](const httplib::Request &req, httplib::Response &res) {
+        writes.execute(StoreLocks::Customers, StoreLocks::Rooms | StoreLocks::Reservations | StoreLocks::Invoices, [&]() {
+            try {
+                auto d = json::parse(req.body);
+                std::string reservationId = d.at("reservationId");
+                std::string roomId = d.at("roomId");
+
+                const int inD = d.at("checkInDay"), inM = d.at("checkInMonth"), inY = d.at("checkInYear");
+                const int outD = d.at("checkOutDay"), outM = d.at("checkOutMonth"), outY = d.at("checkOutYear");
+                if (!isValidCivil(inY, inM, inD) || !isValidCivil(outY, outM, outD)) {
+                    res.status = 400;
+                    res.set_content("{\"error\":\"Invalid date\"}", "application/json");
+                    return;
+                }
 
-        for (int i = 0; i < n; ++i) {
-            const Reservation &r = rs[i];
-            json j = reservationToJson(r);
-            if (Customer* c = custMgr.findCustomer(std::string(r.customerId))) {
-                j["fullName"] = std::string(c->fullName);
+                // The reservation and the room status commit together or not at all.
+                StoreTransaction tx(roomMgr, resMgr, invMgr, txJournal);
+                tx.touchReservation(reservationId);
+                tx.touchRoom(roomId);
+                bool ok = resMgr.makeReservation(
+                    reservationId, d.at("customerId"), roomId,
+                    daysFromCivil(inY, inM, inD), daysFromCivil(outY, outM, outD),
+                    custMgr, roomMgr
+                );
+                if (!ok) {
+                    res.status = 400;
+                    res.set_content("{\"error\":\"Reservation failed\"}", "application/json");
+                    return;
+                }
+                if (!tx.commit()) {
+                    res.status = 500;
+                    res.set_content("{\"error\":\"Failed to save reservation\"}", "application/json");
+                    return;
+                }
+                res.status = 201;
+                res.set_content("{\"message\":\"Reservation made\"}", "application/json");
+            } catch (const std::exception &e) {
+                res.status = 400;
+                res.set_content(json{{"error", e.what()}}.dump(), "application/json");
             }
-            arr.push_back(j);
-        }
-        res.set_content(arr.dump(), "application/json");
+        });
     });
 
-    app.Post("/api/reservations", [&resMgr, &custMgr, &roomMgr](const httplib::Request &req, httplib::Response &res) {
+    // Check-in endpoint
+    app.Post("/api/reservations/checkin", [&resMgr, &roomMgr, &locks, &writes](const httplib::Request &req, httplib::Response &res) {
+        std::string reservationId;
         try {
             auto d = json::parse(req.body);
-            bool ok = resMgr.makeReservation(
-                d.at("reservationId"), d.at("customerId"), d.at("roomId"),
-                d.at("checkInDay"), d.at("checkInMonth"), d.at("checkInYear"),
-                d.at("checkOutDay"), d.at("checkOutMonth"), d.at("checkOutYear"),
-                custMgr, roomMgr
-            );
-            if (!ok) {
-                res.status = 400;
-                res.set_content("{\"error\":\"Reservation failed\"}", "application/json");
-                return;
-            }
-            res.status = 201;
-            res.set_content("{\"message\":\"Reservation made\"}", "application/json");
+            reservationId = d.at("reservationId").get<std::string>();
         } catch (const std::exception &e) {
             res.status = 400;
             res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+            return;
         }
-    });
-
-    // Check-in endpoint
-    app.Post("/api/reservations/checkin", [&resMgr, &roomMgr](const httplib::Request &req, httplib::Response &res) {
-        try {
-            auto d = json::parse(req.body);
-            std::string reservationId = d.at("reservationId");
+        executeForReservation(writes, locks, resMgr, reservationId, StoreLocks::Rooms | StoreLocks::Reservations, [&]() {
             bool ok = resMgr.checkInByReservationId(reservationId, roomMgr);
             if (!ok) {
                 res.status = 400;
@@ -352,17 +580,21 @@ int main() {
             }
             res.status = 200;
             res.set_content("{\"message\":\"Checked in successfully\"}", "application/json");
-        } catch (const std::exception &e) {
-            res.status = 400;
-            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
-        }
+        });
     });
 
     // Cancel reservation endpoint
-    app.Post("/api/reservations/cancel", [&resMgr, &roomMgr](const httplib::Request &req, httplib::Response &res) {
+    app.Post("/api/reservations/cancel", [&resMgr, &roomMgr, &locks, &writes](const httplib::Request &req, httplib::Response &res) {
+        std::string reservationId;
         try {
             auto d = json::parse(req.body);
-            std::string reservationId = d.at("reservationId");
+            reservationId = d.at("reservationId").get<std::string>();
+        } catch (const std::exception &e) {
+            res.status = 400;
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+            return;
+        }
+        executeForReservation(writes, locks, resMgr, reservationId, StoreLocks::Rooms | StoreLocks::Reservations, [&]() {
             bool ok = resMgr.cancelReservation(reservationId, roomMgr);
             if (!ok) {
                 res.status = 400;
@@ -371,137 +603,147 @@ int main() {
             }
             res.status = 200;
             res.set_content("{\"message\":\"Reservation cancelled successfully\"}", "application/json");
-        } catch (const std::exception &e) {
-            res.status = 400;
-            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
-        }
+        });
     });
 
     // Update reservation (mainly for status updates)
-    app.Put(R"(/api/reservations/(.+))", [&resMgr](const httplib::Request &req, httplib::Response &res) {
-        try {
-            std::string reservationId = req.matches[1];
-            auto d = json::parse(req.body);
-            
-            if (!resMgr.findReservationById(reservationId)) {
-                res.status = 404;
-                res.set_content("{\"error\":\"Reservation not found\"}", "application/json");
-                return;
-            }
+    app.Get(R"(/api/reservations/(.+))", [&resMgr, &locks](const httplib::Request &req, httplib::Response &res) {
+        auto guard = locks.read(StoreLocks::Reservations);
+        std::string reservationId = req.matches[1];
+        Reservation* reservation = resMgr.findReservationById(reservationId);
+        if (!reservation) {
+            res.status = 404;
+            res.set_content("{\"error\":\"Reservation not found\"}", "application/json");
+            return;
+        }
+        res.set_header("ETag", recordETag(reservation->revision));
+        res.set_content(recordBody(*reservation), "application/json");
+    });
+
+    app.Put(R"(/api/reservations/(.+))", [&resMgr, &locks, &writes](const httplib::Request &req, httplib::Response &res) {
+        const std::string reservationId = req.matches[1];
+        executeForReservation(writes, locks, resMgr, reservationId, StoreLocks::Reservations, [&]() {
+            try {
+                auto d = json::parse(req.body);
             
-            // Update status if provided
-            if (d.contains("status")) {
-                std::string newStatus = d.at("status");
-                if (!resMgr.updateStatus(reservationId, newStatus)) {
-                    res.status = 400;
-                    res.set_content("{\"error\":\"Failed to update status\"}", "application/json");
+                Reservation* reservation = resMgr.findReservationById(reservationId);
+                if (!reservation) {
+                    res.status = 404;
+                    res.set_content("{\"error\":\"Reservation not found\"}", "application/json");
+                    return;
+                }
+                const std::string etag = recordETag(reservation->revision);
+                if (!ifMatchAllows(req, etag)) {
+                    preconditionFailed(res, etag);
                     return;
                 }
-            }
             
-            res.status = 200;
-            res.set_content("{\"message\":\"Reservation updated successfully\"}", "application/json");
-        } catch (const std::exception &e) {
-            res.status = 400;
-            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
-        }
-    });
-
-    // Delete reservation by id
-    app.Delete(R"(/api/reservations/(.+))", [&resMgr, &roomMgr](const httplib::Request &req, httplib::Response &res) {
-        try {
-            std::string reservationId = req.matches[1];
-            bool ok = resMgr.deleteReservation(reservationId, roomMgr);
-            if (!ok) {
-                res.status = 404;
-                res.set_content("{\"error\":\"Reservation not found\"}", "application/json");
-                return;
+                // Update status if provided
+                if (d.contains("status")) {
+                    const std::string statusName = d.at("status");
+                    ReservationStatus newStatus;
+                    if (!parseReservationStatus(statusName, newStatus)) {
+                        res.status = 400;
+                        res.set_content(json{{"error", "Unknown status: " + statusName}}.dump(), "application/json");
+                        return;
+                    }
+                    if (!resMgr.updateStatus(reservationId, newStatus)) {
+                        res.status = 400;
+                        res.set_content("{\"error\":\"Failed to update status\"}", "application/json");
+                        return;
+                    }
+                }
+            
+                res.status = 200;
+                if (Reservation* updated = resMgr.findReservationById(reservationId)) {
+                    res.set_header("ETag", recordETag(updated->revision));
+                }
+                res.set_content("{\"message\":\"Reservation updated successfully\"}", "application/json");
+            } catch (const std::exception &e) {
+                res.status = 400;
+                res.set_content(json{{"error", e.what()}}.dump(), "application/json");
             }
-            res.status = 200;
-            res.set_content("{\"message\":\"Reservation deleted\"}", "application/json");
-        } catch (const std::exception &e) {
-            res.status = 400;
-            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
-        }
+        });
     });
 
-    // Service management: list all rooms that currently have services
-    app.Get("/api/service/rooms", [&roomMgr, &resMgr, &custMgr](const httplib::Request &, httplib::Response &res) {
-        auto rooms = roomMgr.getRooms();
-        int roomCount = roomMgr.getRoomCount();
-        auto reservations = resMgr.getReservations();
-        int resCount = resMgr.getReservationCount();
-
-        // Map roomId -> active reservation (prefer checkedIn over pending)
-        std::unordered_map<std::string, const Reservation*> activeMap;
-        for (int i = 0; i < resCount; ++i) {
-            const Reservation& r = reservations[i];
-            std::string status = std::string(r.status);
-            if (status != "checkedIn" && status != "pending") continue;
-            std::string roomId = std::string(r.roomId);
-            auto it = activeMap.find(roomId);
-            if (it == activeMap.end()) {
-                activeMap[roomId] = &r;
-            } else {
-                // Upgrade pending -> checkedIn if both exist
-                if (std::string(it->second->status) == "pending" && status == "checkedIn") {
-                    it->second = &r;
+    // Delete reservation by id
+    app.Delete(R"(/api/reservations/(.+))", [&resMgr, &roomMgr, &writes](const httplib::Request &req, httplib::Response &res) {
+        writes.execute(0, StoreLocks::Rooms | StoreLocks::Reservations, [&]() {
+            try {
+                std::string reservationId = req.matches[1];
+                if (Reservation* reservation = resMgr.findReservationById(reservationId)) {
+                    const std::string etag = recordETag(reservation->revision);
+                    if (!ifMatchAllows(req, etag)) {
+                        preconditionFailed(res, etag);
+                        return;
+                    }
                 }
-            }
-        }
-
-        json arr = json::array();
-        for (int i = 0; i < roomCount; ++i) {
-            const Room& room = rooms[i];
-            if (room.serviceList == nullptr) continue; // only rooms with services
-
-            std::string roomId = std::string(room.roomId);
-            const Reservation* r = nullptr;
-            auto it = activeMap.find(roomId);
-            if (it != activeMap.end()) r = it->second;
-
-            std::string customerId;
-            std::string reservationId;
-            std::string reservationStatus;
-            if (r) {
-                customerId = std::string(r->customerId);
-                reservationId = std::string(r->reservationId);
-                reservationStatus = std::string(r->status);
-            }
-
-            std::string customerName;
-            if (!customerId.empty()) {
-                if (Customer* c = custMgr.findCustomer(customerId)) {
-                    customerName = std::string(c->fullName);
+                bool ok = resMgr.deleteReservation(reservationId, roomMgr);
+                if (!ok) {
+                    res.status = 404;
+                    res.set_content("{\"error\":\"Reservation not found\"}", "application/json");
+                    return;
                 }
+                res.status = 200;
+                res.set_content("{\"message\":\"Reservation deleted\"}", "application/json");
+            } catch (const std::exception &e) {
+                res.status = 400;
+                res.set_content(json{{"error", e.what()}}.dump(), "application/json");
             }
+        });
+    });
 
-            int serviceCount = 0;
-            for (Service* svc = room.serviceList; svc != nullptr; svc = svc->next) {
-                ++serviceCount;
-            }
-
-            double serviceCharge = ServiceManagement::calculateServiceCharge(roomMgr, roomId);
-
-            json j = {
-                {"roomId", roomId},
-                {"roomType", std::string(room.roomType)},
-                {"pricePerDay", room.pricePerDay},
-                {"isAvailable", room.isAvailable},
-                {"reservationId", reservationId},
-                {"reservationStatus", reservationStatus},
-                {"customerId", customerId},
-                {"customerName", customerName},
-                {"serviceCount", serviceCount},
-                {"serviceCharge", serviceCharge}
-            };
-            arr.push_back(j);
-        }
-        res.set_content(arr.dump(), "application/json");
+    // Service management: list all rooms that currently have services
+    app.Get("/api/service/rooms", [&roomMgr, &resMgr, &custMgr, &locks, &serviceRoomView](const httplib::Request &, httplib::Response &res) {
+        auto body = serviceRoomView.get(
+            [&roomMgr, &resMgr, &custMgr]() { return roomMgr.getVersion() + custMgr.getVersion() + resMgr.getVersion(); },
+            [&locks]() { return locks.read(StoreLocks::Rooms | StoreLocks::Customers | StoreLocks::Reservations); },
+            [&roomMgr, &resMgr, &custMgr]() {
+                json arr = json::array();
+                roomMgr.forEachRoom([&](const Room& room) {
+                    if (room.services.empty()) return; // only rooms with services
+
+                    // Active reservation (prefer checkedIn over pending)
+                    const Reservation* r = resMgr.findActiveReservation(room.roomId);
+
+                    std::string customerId;
+                    std::string reservationId;
+                    std::string reservationStatus;
+                    std::string customerName;
+                    if (r) {
+                        customerId = r->customerId.str();
+                        reservationId = std::string(r->reservationId);
+                        reservationStatus = reservationStatusName(r->status);
+                        if (Customer* c = custMgr.findCustomer(r->customerId)) {
+                            customerName = std::string(c->fullName);
+                        }
+                    }
+
+                    int serviceCount = static_cast<int>(room.services.size());
+                    double serviceCharge = ServiceManagement::calculateServiceCharge(room);
+
+                    json j = {
+                        {"roomId", room.roomId.str()},
+                        {"roomType", room.roomType.str()},
+                        {"pricePerDay", room.pricePerDay},
+                        {"isAvailable", room.isAvailable},
+                        {"reservationId", reservationId},
+                        {"reservationStatus", reservationStatus},
+                        {"customerId", customerId},
+                        {"customerName", customerName},
+                        {"serviceCount", serviceCount},
+                        {"serviceCharge", serviceCharge}
+                    };
+                    arr.push_back(j);
+                });
+                return arr.dump();
+            });
+        setViewContent(res, std::move(body));
     });
 
     // Service management: list services of a room
-    app.Get(R"(/api/service/rooms/(.+)/services)", [&roomMgr](const httplib::Request &req, httplib::Response &res) {
+    app.Get(R"(/api/service/rooms/(.+)/services)", [&roomMgr, &locks](const httplib::Request &req, httplib::Response &res) {
+        auto guard = locks.read(StoreLocks::Rooms);
         std::string roomId = req.matches[1];
         Room* room = roomMgr.findRoom(roomId);
         if (!room) {
@@ -511,185 +753,207 @@ int main() {
         }
         json payload = serviceListToJson(*room);
         payload["roomId"] = roomId;
+        res.set_header("ETag", recordETag(room->revision));
         res.set_content(payload.dump(), "application/json");
     });
 
     // Service management: add service to room
-    app.Post(R"(/api/service/rooms/(.+)/services)", [&roomMgr](const httplib::Request &req, httplib::Response &res) {
-        auto start = std::chrono::high_resolution_clock::now();
-        try {
-            std::string roomId = req.matches[1];
-            auto d = json::parse(req.body);
-            std::string name = d.at("serviceName");
-            double price = d.at("price");
-            int quantity = d.value("quantity", 1);
-            if (quantity <= 0) quantity = 1;
+    app.Post(R"(/api/service/rooms/(.+)/services)", [&roomMgr, &writes](const httplib::Request &req, httplib::Response &res) {
+        const std::string roomId = req.matches[1];
+        writes.executeForRoom(StoreLocks::Rooms, roomId, [&]() {
+            auto start = std::chrono::high_resolution_clock::now();
+            try {
+                auto d = json::parse(req.body);
+                std::string name = d.at("serviceName");
+                double price = d.at("price");
+                int quantity = d.value("quantity", 1);
+                if (quantity <= 0) quantity = 1;
+                if (!ServiceManagement::isValidServiceName(name)) {
+                    res.status = 400;
+                    res.set_content("{\"error\":\"Invalid service name\"}", "application/json");
+                    return;
+                }
 
-            bool ok = ServiceManagement::addServiceToRoom(roomMgr, roomId, name, price, quantity);
-            if (!ok) {
+                if (Room* current = roomMgr.findRoom(roomId)) {
+                    const std::string etag = recordETag(current->revision);
+                    if (!ifMatchAllows(req, etag)) {
+                        preconditionFailed(res, etag);
+                        return;
+                    }
+                }
+                bool ok = ServiceManagement::addServiceToRoom(roomMgr, roomId, name, price, quantity);
+                if (!ok) {
+                    res.status = 400;
+                    res.set_content("{\"error\":\"Cannot add service for this room\"}", "application/json");
+                    return;
+                }
+                Room* room = roomMgr.findRoom(roomId);
+                if (!room) {
+                    res.status = 404;
+                    res.set_content("{\"error\":\"Room not found after update\"}", "application/json");
+                    return;
+                }
+                auto end = std::chrono::high_resolution_clock::now();
+                std::chrono::duration<double, std::milli> elapsed = end - start;
+                json payload = serviceListToJson(*room);
+                payload["roomId"] = roomId;
+                payload["executionMs"] = elapsed.count();
+                res.status = 201;
+                res.set_header("ETag", recordETag(room->revision));
+                res.set_content(payload.dump(), "application/json");
+            } catch (const std::exception &e) {
                 res.status = 400;
-                res.set_content("{\"error\":\"Cannot add service for this room\"}", "application/json");
-                return;
+                res.set_content(json{{"error", e.what()}}.dump(), "application/json");
             }
+        });
+    });
+
+    // Service management: delete service by index
+    app.Delete(R"(/api/service/rooms/(.+)/services/(\d+))", [&roomMgr, &writes](const httplib::Request &req, httplib::Response &res) {
+        const std::string roomId = req.matches[1];
+        writes.executeForRoom(StoreLocks::Rooms, roomId, [&]() {
+            int index = std::stoi(req.matches[2]);
             Room* room = roomMgr.findRoom(roomId);
             if (!room) {
                 res.status = 404;
-                res.set_content("{\"error\":\"Room not found after update\"}", "application/json");
+                res.set_content("{\"error\":\"Room not found\"}", "application/json");
+                return;
+            }
+            const std::string etag = recordETag(room->revision);
+            if (!ifMatchAllows(req, etag)) {
+                preconditionFailed(res, etag);
+                return;
+            }
+            bool ok = ServiceManagement::removeServiceByIndex(roomMgr, roomId, index);
+            if (!ok) {
+                res.status = 400;
+                res.set_content("{\"error\":\"Service index invalid\"}", "application/json");
                 return;
             }
-            auto end = std::chrono::high_resolution_clock::now();
-            std::chrono::duration<double, std::milli> elapsed = end - start;
             json payload = serviceListToJson(*room);
             payload["roomId"] = roomId;
-            payload["executionMs"] = elapsed.count();
-            res.status = 201;
+            res.set_header("ETag", recordETag(room->revision));
             res.set_content(payload.dump(), "application/json");
-        } catch (const std::exception &e) {
-            res.status = 400;
-            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
-        }
-    });
-
-    // Service management: delete service by index
-    app.Delete(R"(/api/service/rooms/(.+)/services/(\d+))", [&roomMgr](const httplib::Request &req, httplib::Response &res) {
-        std::string roomId = req.matches[1];
-        int index = std::stoi(req.matches[2]);
-        Room* room = roomMgr.findRoom(roomId);
-        if (!room) {
-            res.status = 404;
-            res.set_content("{\"error\":\"Room not found\"}", "application/json");
-            return;
-        }
-        bool ok = ServiceManagement::removeServiceByIndex(roomMgr, roomId, index);
-        if (!ok) {
-            res.status = 400;
-            res.set_content("{\"error\":\"Service index invalid\"}", "application/json");
-            return;
-        }
-        json payload = serviceListToJson(*room);
-        payload["roomId"] = roomId;
-        res.set_content(payload.dump(), "application/json");
+        });
     });
 
     // Checkout endpoint - processes checkout and creates invoice
-    app.Post("/api/checkout", [&resMgr, &roomMgr, &invMgr](const httplib::Request &req, httplib::Response &res) {
-        try {
-            auto d = json::parse(req.body);
-            std::string reservationId = d.at("reservationId");
+    app.Post("/api/checkout", [&resMgr, &roomMgr, &invMgr, &txJournal, &writes](const httplib::Request &req, httplib::Response &res) {
+        writes.execute(0, StoreLocks::Rooms | StoreLocks::Reservations | StoreLocks::Invoices, [&]() {
+            try {
+                auto d = json::parse(req.body);
+                std::string reservationId = d.at("reservationId");
             
-            // Find reservation
-            Reservation* reservation = resMgr.findReservationById(reservationId);
-            if (!reservation) {
-                res.status = 404;
-                res.set_content("{\"error\":\"Reservation not found\"}", "application/json");
-                return;
-            }
+                // Find reservation
+                Reservation* reservation = resMgr.findReservationById(reservationId);
+                if (!reservation) {
+                    res.status = 404;
+                    res.set_content("{\"error\":\"Reservation not found\"}", "application/json");
+                    return;
+                }
             
-            // Validate reservation status
-            if (reservation->status != "checkedIn") {
-                res.status = 400;
-                res.set_content("{\"error\":\"Only checked-in reservations can be checked out\"}", "application/json");
-                return;
-            }
+                // Validate reservation status
+                if (reservation->status != ReservationStatus::CheckedIn) {
+                    res.status = 400;
+                    res.set_content("{\"error\":\"Only checked-in reservations can be checked out\"}", "application/json");
+                    return;
+                }
             
-            // Find room to get pricing
-            Room* room = roomMgr.findRoom(reservation->roomId);
-            if (!room) {
-                res.status = 404;
-                res.set_content("{\"error\":\"Room not found\"}", "application/json");
-                return;
-            }
+                // Find room to get pricing
+                Room* room = roomMgr.findRoom(reservation->roomId);
+                if (!room) {
+                    res.status = 404;
+                    res.set_content("{\"error\":\"Room not found\"}", "application/json");
+                    return;
+                }
             
-            // Calculate stay duration
-            auto daysBetween = [](int y1, int m1, int d1, int y2, int m2, int d2) -> int {
-                // Simple calculation (not accounting for leap years perfectly, but good enough)
-                int days1 = y1 * 365 + m1 * 30 + d1;
-                int days2 = y2 * 365 + m2 * 30 + d2;
-                return days2 - days1;
-            };
-            int days = daysBetween(
-                reservation->checkInYear, reservation->checkInMonth, reservation->checkInDay,
-                reservation->checkOutYear, reservation->checkOutMonth, reservation->checkOutDay
-            );
-            if (days <= 0) days = 1;
+                // Calculate stay duration
+                int days = InvoiceManager::calculateDays(reservation->checkIn, reservation->checkOut);
             
-            // Calculate room charge
-            double roomCharge = room->pricePerDay * days;
+                // Calculate room charge
+                double roomCharge = room->pricePerDay * days;
             
-            // Calculate service charge
-            double serviceCharge = 0.0;
-            for (Service* svc = room->serviceList; svc != nullptr; svc = svc->next) {
-                serviceCharge += svc->price * svc->quantity;
-            }
+                // Calculate service charge
+                double serviceCharge = ServiceManagement::calculateServiceCharge(*room);
             
-            double totalAmount = roomCharge + serviceCharge;
-
-            // Create & persist invoice first (uses current services, before clearing them)
-            Invoice newInvoice;
-            newInvoice.invoiceId = "INV" + std::to_string(invMgr.getInvoiceCount() + 1);
-            newInvoice.customerId = reservation->customerId;
-            newInvoice.roomId = reservation->roomId;
-            newInvoice.checkInDay = reservation->checkInDay;
-            newInvoice.checkInMonth = reservation->checkInMonth;
-            newInvoice.checkInYear = reservation->checkInYear;
-            newInvoice.checkOutDay = reservation->checkOutDay;
-            newInvoice.checkOutMonth = reservation->checkOutMonth;
-            newInvoice.checkOutYear = reservation->checkOutYear;
-            newInvoice.roomCharge = roomCharge;
-            newInvoice.serviceCharge = serviceCharge;
-            newInvoice.totalAmount = totalAmount;
-
-            if (!invMgr.addInvoice(newInvoice)) {
-                res.status = 500;
-                res.set_content("{\"error\":\"Failed to create invoice\"}", "application/json");
-                return;
-            }
+                double totalAmount = roomCharge + serviceCharge;
+
+                // Invoice, reservation status and room status commit together; any
+                // failure below rolls all three back.
+                StoreTransaction tx(roomMgr, resMgr, invMgr, txJournal);
+
+                // Create invoice first (uses current services, before clearing them)
+                Invoice newInvoice;
+                newInvoice.invoiceId = "INV" + std::to_string(invMgr.getInvoiceCount() + 1);
+                newInvoice.customerId = reservation->customerId;
+                newInvoice.roomId = reservation->roomId;
+                newInvoice.checkIn = reservation->checkIn;
+                newInvoice.checkOut = reservation->checkOut;
+                newInvoice.roomCharge = roomCharge;
+                newInvoice.serviceCharge = serviceCharge;
+                newInvoice.totalAmount = totalAmount;
+
+                const std::string roomId = reservation->roomId.str();
+                tx.touchInvoice(newInvoice.invoiceId);
+                tx.touchReservation(reservationId);
+                tx.touchRoom(roomId);
+
+                if (!invMgr.addInvoice(newInvoice)) {
+                    res.status = 500;
+                    res.set_content("{\"error\":\"Failed to create invoice\"}", "application/json");
+                    return;
+                }
 
-            // Update reservation status and persist
-            if (!resMgr.updateStatus(reservationId, "checkedOut")) {
-                res.status = 500;
-                res.set_content("{\"error\":\"Failed to update reservation status\"}", "application/json");
-                return;
-            }
+                // Update reservation status
+                if (!resMgr.updateStatus(reservationId, ReservationStatus::CheckedOut)) {
+                    res.status = 500;
+                    res.set_content("{\"error\":\"Failed to update reservation status\"}", "application/json");
+                    return;
+                }
 
-            // Mark room available (also clears services + persists)
-            roomMgr.updateRoomStatus(reservation->roomId, true);
+                // Mark room available (also clears services)
+                roomMgr.updateRoomStatus(roomId, true);
 
-            json result = invoiceToJson(newInvoice);
-            res.status = 200;
-            res.set_content(result.dump(), "application/json");
+                if (!tx.commit()) {
+                    res.status = 500;
+                    res.set_content("{\"error\":\"Failed to save checkout\"}", "application/json");
+                    return;
+                }
+
+                res.status = 200;
+                res.set_content(recordBody(newInvoice), "application/json");
             
-        } catch (const std::exception &e) {
-            res.status = 400;
-            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
-        }
+            } catch (const std::exception &e) {
+                res.status = 400;
+                res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+            }
+        });
     });
 
     // Aggregate all services across rooms (flattened list)
-    app.Get("/api/services", [&roomMgr](const httplib::Request &, httplib::Response &res) {
-        auto rooms = roomMgr.getRooms();
-        int n = roomMgr.getRoomCount();
+    app.Get("/api/services", [&roomMgr, &locks](const httplib::Request &, httplib::Response &res) {
+        auto guard = locks.read(StoreLocks::Rooms);
         json arr = json::array();
-        for (int i = 0; i < n; ++i) {
-            const Room &room = rooms[i];
+        roomMgr.forEachRoom([&arr](const Room &room) {
             int idx = 0;
-            for (Service* svc = room.serviceList; svc != nullptr; svc = svc->next) {
+            for (const Service& svc : room.services) {
                 arr.push_back({
-                    {"roomId", std::string(room.roomId)},
-                    {"serviceName", std::string(svc->serviceName)},
-                    {"price", svc->price},
-                    {"quantity", svc->quantity},
-                    {"total", svc->price * svc->quantity},
+                    {"roomId", room.roomId.str()},
+                    {"serviceName", svc.serviceName.str()},
+                    {"price", svc.price},
+                    {"quantity", svc.quantity},
+                    {"total", svc.price * svc.quantity},
                     {"index", idx}
                 });
                 ++idx;
             }
-        }
+        });
         res.set_content(arr.dump(), "application/json");
     });
 
     // Find room combination using backtracking
-    app.Post("/api/rooms/combination", [&roomMgr](const httplib::Request &req, httplib::Response &res) {
+    app.Post("/api/rooms/combination", [&roomMgr, &locks](const httplib::Request &req, httplib::Response &res) {
+        auto guard = locks.read(StoreLocks::Rooms);
         try {
             auto body = json::parse(req.body);
             if (!body.contains("requests") || !body["requests"].is_array()) {
@@ -715,7 +979,10 @@ int main() {
 
             RoomCombinationSolver solver;
             auto start = std::chrono::high_resolution_clock::now();
-            bool ok = solver.findRoomCombination(requests, roomMgr.getRooms(), roomMgr.getRoomCount());
+            std::vector<Room*> rooms;
+            rooms.reserve(static_cast<size_t>(roomMgr.getRoomCount()));
+            roomMgr.forEachRoom([&rooms](Room& room) { rooms.push_back(&room); });
+            bool ok = solver.findRoomCombination(requests, rooms);
             auto end = std::chrono::high_resolution_clock::now();
             std::chrono::duration<double, std::milli> elapsed = end - start;
 
@@ -731,8 +998,8 @@ int main() {
             for (auto *room : solution) {
                 if (!room) continue;
                 arr.push_back({
-                    {"roomId", std::string(room->roomId)},
-                    {"roomType", std::string(room->roomType)},
+                    {"roomId", room->roomId.str()},
+                    {"roomType", room->roomType.str()},
                     {"pricePerDay", room->pricePerDay}
                 });
                 total += room->pricePerDay;
@@ -752,53 +1019,104 @@ int main() {
     });
 
     // Invoices
-    app.Get("/api/invoices", [&invMgr](const httplib::Request &, httplib::Response &res) {
-        auto ivs = invMgr.getInvoices();
-        int n = invMgr.getInvoiceCount();
-        json arr = json::array();
-        for (int i = 0; i < n; ++i) arr.push_back(invoiceToJson(ivs[i]));
-        res.set_content(arr.dump(), "application/json");
+    app.Get("/api/invoices", [&invMgr, &locks, &invoiceView](const httplib::Request &, httplib::Response &res) {
+        auto body = invoiceView.get(
+            [&invMgr]() { return invMgr.getVersion(); },
+            [&locks]() { return locks.read(StoreLocks::Invoices); },
+            [&invMgr]() {
+                std::string body;
+                body.reserve(static_cast<size_t>(invMgr.getInvoiceCount()) * 320);
+                JsonWriter w(body);
+                w.beginArray();
+                invMgr.forEachInvoice([&w](const Invoice& inv) { inv.writeCachedJson(w); });
+                w.endArray();
+                return body;
+            });
+        setViewContent(res, std::move(body));
     });
 
     // Delete invoice by id
-    app.Delete(R"(/api/invoices/(.+))", [&invMgr](const httplib::Request &req, httplib::Response &res) {
-        try {
-            std::string invoiceId = req.matches[1];
-            bool ok = invMgr.deleteInvoice(invoiceId);
-            if (!ok) {
-                res.status = 404;
-                res.set_content("{\"error\":\"Invoice not found\"}", "application/json");
-                return;
+    app.Delete(R"(/api/invoices/(.+))", [&invMgr, &writes](const httplib::Request &req, httplib::Response &res) {
+        writes.execute(0, StoreLocks::Invoices, [&]() {
+            try {
+                std::string invoiceId = req.matches[1];
+                if (Invoice* invoice = invMgr.findInvoiceById(invoiceId)) {
+                    const std::string etag = recordETag(invoice->revision);
+                    if (!ifMatchAllows(req, etag)) {
+                        preconditionFailed(res, etag);
+                        return;
+                    }
+                }
+                bool ok = invMgr.deleteInvoice(invoiceId);
+                if (!ok) {
+                    res.status = 404;
+                    res.set_content("{\"error\":\"Invoice not found\"}", "application/json");
+                    return;
+                }
+                res.status = 200;
+                res.set_content("{\"message\":\"Invoice deleted\"}", "application/json");
+            } catch (const std::exception &e) {
+                res.status = 400;
+                res.set_content(json{{"error", e.what()}}.dump(), "application/json");
             }
-            res.status = 200;
-            res.set_content("{\"message\":\"Invoice deleted\"}", "application/json");
-        } catch (const std::exception &e) {
-            res.status = 400;
-            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
-        }
+        });
     });
 
     // Sync invoices from reservations (create missing invoices for checked-out reservations)
-    app.Post("/api/invoices/sync", [&invMgr, &resMgr, &roomMgr](const httplib::Request &, httplib::Response &res) {
-        int created = invMgr.syncFromReservations(resMgr, roomMgr);
+    app.Post("/api/invoices/sync", [&invMgr, &resMgr, &roomMgr, &writes](const httplib::Request &, httplib::Response &res) {
+        writes.execute(StoreLocks::Rooms | StoreLocks::Reservations, StoreLocks::Invoices, [&]() {
+            int created = invMgr.syncFromReservations(resMgr, roomMgr);
+            json result = {
+                {"message", "Invoices synchronized"},
+                {"created", created},
+                {"total", invMgr.getInvoiceCount()}
+            };
+            res.status = 200;
+            res.set_content(result.dump(), "application/json");
+        });
+    });
+
+    // Strict rebuild: overwrite invoices.json only with checkedOut reservations
+    app.Post("/api/invoices/rebuild", [&invMgr, &resMgr, &roomMgr, &writes](const httplib::Request &, httplib::Response &res) {
+        writes.execute(StoreLocks::Rooms | StoreLocks::Reservations, StoreLocks::Invoices, [&]() {
+            int created = invMgr.rebuildFromReservationsStrict(resMgr, roomMgr);
+            json result = {
+                {"message", "Invoices rebuilt strictly from reservations"},
+                {"created", created},
+                {"total", invMgr.getInvoiceCount()}
+            };
+            res.status = 200;
+            res.set_content(result.dump(), "application/json");
+        });
+    });
+
+    // Checkpoint all stores on the snapshot thread (BGSAVE); returns immediately.
+    app.Post("/api/snapshot", [&](const httplib::Request &, httplib::Response &res) {
+        auto guard = locks.read(StoreLocks::All);
+        if (!backgroundSnapshots) {
+            res.status = 409;
+            res.set_content("{\"error\":\"Background snapshots are disabled\"}", "application/json");
+            return;
+        }
         json result = {
-            {"message", "Invoices synchronized"},
-            {"created", created},
-            {"total", invMgr.getInvoiceCount()}
+            {"rooms", roomMgr.checkpointInBackground()},
+            {"customers", custMgr.checkpointInBackground()},
+            {"reservations", resMgr.checkpointInBackground()},
+            {"invoices", invMgr.checkpointInBackground()}
         };
-        res.status = 200;
+        res.status = 202;
         res.set_content(result.dump(), "application/json");
     });
 
-    // Strict rebuild: overwrite invoices.json only with checkedOut reservations
-    app.Post("/api/invoices/rebuild", [&invMgr, &resMgr, &roomMgr](const httplib::Request &, httplib::Response &res) {
-        int created = invMgr.rebuildFromReservationsStrict(resMgr, roomMgr);
+    // Export all stores as JSON (the import/export format when --storage binary is used).
+    app.Post("/api/export", [&](const httplib::Request &, httplib::Response &res) {
+        auto guard = locks.read(StoreLocks::All);
         json result = {
-            {"message", "Invoices rebuilt strictly from reservations"},
-            {"created", created},
-            {"total", invMgr.getInvoiceCount()}
+            {"rooms", roomMgr.exportToJson()},
+            {"customers", custMgr.exportToJson()},
+            {"reservations", resMgr.exportToJson()},
+            {"invoices", invMgr.exportToJson()}
         };
-        res.status = 200;
         res.set_content(result.dump(), "application/json");
     });
 
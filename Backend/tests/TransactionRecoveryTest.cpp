@@ -0,0 +1,132 @@
+// Crash-recovery checks for StoreTransaction and the transaction journal.
+//
+// A "crash" abandons the managers without destroying them, so nothing still
+// buffered in their logs reaches disk; a fresh set then loads the same
+// directory and runs StoreTransaction::recover(), as server_http does.
+
+#include "InvoiceManagement.h"
+#include "ReservationManagement.h"
+#include "RoomManagement.h"
+#include "StoreTransaction.h"
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+static int failures = 0;
+
+static void check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::cerr << "FAIL: " << what << "\n";
+        ++failures;
+    }
+}
+
+struct Stores {
+    RoomManager rooms;
+    ReservationManager reservations;
+    InvoiceManager invoices;
+    TransactionJournal journal{"transactions.log"};
+
+    void load() {
+        rooms.loadFromFile();
+        reservations.loadFromFile();
+        invoices.loadFromFile();
+    }
+};
+
+static void enterFreshDirectory(const fs::path& dir) {
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    fs::current_path(dir);
+}
+
+static Invoice makeInvoice(const std::string& id) {
+    Invoice inv;
+    inv.invoiceId = id;
+    inv.customerId = "C001";
+    inv.roomId = "R101";
+    inv.roomCharge = 100;
+    inv.totalAmount = 100;
+    return inv;
+}
+
+// Checkout commits (R101 available, INV1 created); the room log is flushed,
+// a later plain write marks R101 occupied again and is flushed too, but the
+// invoice log never is. Recovery must restore INV1 without rolling R101 back.
+static void replaySkipsStoresThatHoldTheTransaction(const fs::path& root) {
+    enterFreshDirectory(root / "partial");
+    Stores* before = new Stores();
+    before->load();
+    before->rooms.getOperationLog().setBuffered(true);
+    before->reservations.getOperationLog().setBuffered(true);
+    before->invoices.getOperationLog().setBuffered(true);
+    before->rooms.addRoom("R101", "Standard", 100);
+    before->rooms.updateRoomStatus("R101", false);
+    before->rooms.getOperationLog().flushPending();
+
+    {
+        StoreTransaction tx(before->rooms, before->reservations, before->invoices, before->journal);
+        tx.touchInvoice("INV1");
+        tx.touchRoom("R101");
+        before->invoices.addInvoice(makeInvoice("INV1"));
+        before->rooms.updateRoomStatus("R101", true);
+        check(tx.commit(), "checkout commits");
+    }
+    before->rooms.getOperationLog().flushPending();
+    before->rooms.updateRoomStatus("R101", false);
+    before->rooms.getOperationLog().flushPending();
+    before->journal.retire();
+    check(fs::exists("transactions.log"), "journal kept while the invoice log is unflushed");
+    // Crash: *before is abandoned with the invoice record still buffered.
+
+    Stores after;
+    after.load();
+    check(StoreTransaction::recover(after.rooms, after.reservations, after.invoices, after.journal) == 1,
+          "one transaction recovered");
+    Room* room = after.rooms.findRoom(std::string("R101"));
+    check(room && !room->isAvailable, "later write to R101 survives recovery");
+    check(after.invoices.findInvoiceById("INV1") != nullptr, "INV1 restored from the journal");
+}
+
+// Unbuffered logs (--flush-window-ms 0) write the records at commit, so the
+// journal drains on the next retire() instead of growing.
+static void unbufferedCommitDrainsJournal(const fs::path& root) {
+    enterFreshDirectory(root / "unbuffered");
+    Stores* before = new Stores();
+    before->load();
+    before->rooms.addRoom("R101", "Standard", 100);
+    {
+        StoreTransaction tx(before->rooms, before->reservations, before->invoices, before->journal);
+        tx.touchInvoice("INV1");
+        tx.touchRoom("R101");
+        before->invoices.addInvoice(makeInvoice("INV1"));
+        before->rooms.updateRoomStatus("R101", false);
+        check(tx.commit(), "transaction commits");
+    }
+    before->journal.retire();
+    check(!fs::exists("transactions.log"), "journal cleared once the store logs are written");
+
+    Stores after;
+    after.load();
+    check(StoreTransaction::recover(after.rooms, after.reservations, after.invoices, after.journal) == 0,
+          "nothing left to recover");
+    Room* room = after.rooms.findRoom(std::string("R101"));
+    check(room && !room->isAvailable, "R101 occupied after restart");
+    check(after.invoices.findInvoiceById("INV1") != nullptr, "INV1 in the invoice log");
+}
+
+int main() {
+    const fs::path start = fs::current_path();
+    const fs::path root = fs::temp_directory_path() / "hotel_transaction_recovery_test";
+
+    replaySkipsStoresThatHoldTheTransaction(root);
+    unbufferedCommitDrainsJournal(root);
+
+    fs::current_path(start);
+    fs::remove_all(root);
+    if (failures == 0) std::cout << "All transaction recovery checks passed\n";
+    return failures == 0 ? 0 : 1;
+}